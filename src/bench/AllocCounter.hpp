@@ -0,0 +1,25 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QtGlobal>
+
+namespace tagberry::bench {
+
+// Heap allocations made by the process since start, counted by replaced
+// global operator new. Only linked into tagberry-bench.
+struct AllocStats {
+    quint64 count {};
+    quint64 bytes {};
+};
+
+AllocStats allocStats();
+
+} // namespace tagberry::bench
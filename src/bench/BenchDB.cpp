@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "bench/BenchDB.hpp"
+#include "gen/Generator.hpp"
+
+#include <QDebug>
+
+namespace tagberry::bench {
+
+namespace {
+
+bool parseInt(const QString& arg, const QString& name, int& value)
+{
+    const auto prefix = "--" + name + "=";
+    if (!arg.startsWith(prefix)) {
+        return false;
+    }
+
+    bool ok = false;
+    const auto v = arg.mid(prefix.size()).toInt(&ok);
+    if (ok && v >= 0) {
+        value = v;
+    }
+    return ok;
+}
+
+} // namespace
+
+bool BenchConfig::parse(QStringList& args)
+{
+    for (auto it = args.begin(); it != args.end();) {
+        const auto& arg = *it;
+
+        if (!arg.startsWith("--")) {
+            ++it;
+            continue;
+        }
+
+        if (parseInt(arg, "days", days) || parseInt(arg, "records-per-day", recordsPerDay)
+            || parseInt(arg, "tags", tags) || parseInt(arg, "tags-per-record", tagsPerRecord)
+            || parseInt(arg, "description-length", descriptionLength)) {
+            it = args.erase(it);
+            continue;
+        }
+
+        if (arg.contains('=') && !arg.startsWith("--json=")) {
+            qCritical() << "bad option" << arg;
+            return false;
+        }
+
+        ++it;
+    }
+
+    return true;
+}
+
+QString BenchConfig::toString() const
+{
+    return QString("days=%1 records-per-day=%2 tags=%3 tags-per-record=%4"
+                   " description-length=%5")
+        .arg(days)
+        .arg(recordsPerDay)
+        .arg(tags)
+        .arg(tagsPerRecord)
+        .arg(descriptionLength);
+}
+
+BenchDB::BenchDB(const BenchConfig& config)
+    : m_config(config)
+{
+}
+
+bool BenchDB::open()
+{
+    if (!m_dir.isValid()) {
+        qCritical() << "can't create temporary directory";
+        return false;
+    }
+
+    if (!m_storage.open(m_dir.filePath("bench.db"))) {
+        return false;
+    }
+
+    return generate();
+}
+
+storage::LocalStorage& BenchDB::storage()
+{
+    return m_storage;
+}
+
+QDate BenchDB::firstDate() const
+{
+    return QDate(2020, 1, 1);
+}
+
+QDate BenchDB::lastDate() const
+{
+    return firstDate().addDays(m_config.days - 1);
+}
+
+bool BenchDB::generate()
+{
+    gen::GeneratorConfig config;
+
+    config.startDate = firstDate();
+    config.days = m_config.days;
+    config.recordsPerDay = m_config.recordsPerDay;
+    config.tagsPerRecord = m_config.tagsPerRecord;
+    config.tags = m_config.tags;
+    config.descriptionLength = m_config.descriptionLength;
+
+    return gen::Generator(config).run(m_storage);
+}
+
+} // namespace tagberry::bench
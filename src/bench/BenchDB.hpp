@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "storage/LocalStorage.hpp"
+
+#include <QDate>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include <memory>
+
+namespace tagberry::bench {
+
+struct BenchConfig {
+    int days { 730 };
+    int recordsPerDay { 3 };
+    int tags { 200 };
+    int tagsPerRecord { 3 };
+    int descriptionLength { 400 };
+
+    // consumes known --name=value options, leaves the rest for QtTest
+    bool parse(QStringList& args);
+
+    QString toString() const;
+};
+
+// Temporary database filled by generator with fixed seed.
+class BenchDB {
+public:
+    explicit BenchDB(const BenchConfig& config);
+
+    bool open();
+
+    storage::LocalStorage& storage();
+
+    QDate firstDate() const;
+    QDate lastDate() const;
+
+private:
+    bool generate();
+
+    BenchConfig m_config;
+    QTemporaryDir m_dir;
+    storage::LocalStorage m_storage;
+};
+
+} // namespace tagberry::bench
@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "bench/Benchmarks.hpp"
+#include "bench/AllocCounter.hpp"
+#include "gen/Generator.hpp"
+#include "presenters/CalendarArea.hpp"
+#include "widgets/FlowLayout.hpp"
+#include "widgets/MarkdownEdit.hpp"
+#include "widgets/TagLabel.hpp"
+
+#include <QPixmap>
+#include <QtTest>
+
+namespace tagberry::bench {
+
+Benchmarks::Benchmarks(const BenchConfig& config)
+    : m_config(config)
+    , m_db(config)
+{
+}
+
+void Benchmarks::initTestCase()
+{
+    qInfo().noquote() << "generating db:" << m_config.toString();
+
+    QVERIFY(m_db.open());
+}
+
+// six weeks in the middle of generated history, like a calendar page
+QPair<QDate, QDate> Benchmarks::pageRange() const
+{
+    auto from = m_db.firstDate().addDays(m_config.days / 2);
+    return qMakePair(from, from.addDays(41));
+}
+
+// page right after pageRange()
+QPair<QDate, QDate> Benchmarks::nextPageRange() const
+{
+    auto from = pageRange().second.addDays(1);
+    return qMakePair(from, from.addDays(41));
+}
+
+// first record on page having at least two tags
+models::RecordPtr Benchmarks::findRecord(models::RecordsDirectory& recDir) const
+{
+    const auto range = pageRange();
+
+    for (auto date = range.first; date <= range.second; date = date.addDays(1)) {
+        for (auto record : recDir.recordsByDate(date)->getRecords()) {
+            if (record->tags().size() >= 2) {
+                return record;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+void Benchmarks::readPage()
+{
+    QBENCHMARK
+    {
+        models::RecordsDirectory recDir;
+        models::TagsDirectory tagDir;
+
+        m_db.storage().readPage(pageRange(), recDir, tagDir);
+    }
+}
+
+void Benchmarks::saveRecord()
+{
+    models::RecordsDirectory recDir;
+    models::TagsDirectory tagDir;
+
+    QVERIFY(m_db.storage().readPage(pageRange(), recDir, tagDir));
+
+    auto record = findRecord(recDir);
+    QVERIFY(record);
+
+    int n = 0;
+
+    QBENCHMARK
+    {
+        record->setComplete(n % 2 == 1);
+        record->setTitle(QString("title %1").arg(n++));
+
+        m_db.storage().saveRecord(record);
+    }
+}
+
+void Benchmarks::populateRecordsDirectory()
+{
+    const int count = m_config.recordsPerDay * 42;
+
+    QBENCHMARK
+    {
+        models::RecordsDirectory recDir;
+
+        for (int n = 0; n < count; n++) {
+            recDir.loadRecord(quint32(n + 1),
+                m_db.firstDate().addDays(n / m_config.recordsPerDay), false, "title",
+                QString());
+        }
+    }
+}
+
+void Benchmarks::getAllTags()
+{
+    models::RecordsDirectory recDir;
+    models::TagsDirectory tagDir;
+
+    QVERIFY(m_db.storage().readPage(pageRange(), recDir, tagDir));
+
+    // all page records in one set, like a very busy day
+    models::RecordSet recSet(recDir);
+
+    for (auto date = pageRange().first; date <= pageRange().second; date = date.addDays(1)) {
+        for (auto row : recDir.recordsByDate(date)->getRows()) {
+            recSet.addRow(row);
+        }
+    }
+
+    QBENCHMARK
+    {
+        auto tags = recSet.getAllTags();
+        Q_UNUSED(tags);
+    }
+}
+
+// same directory is reused between pages, like in Root
+void Benchmarks::switchPage()
+{
+    models::RecordsDirectory recDir;
+    models::TagsDirectory tagDir;
+
+    int n = 0;
+
+    QBENCHMARK
+    {
+        recDir.clearRecords();
+        tagDir.releaseUnusedTags();
+
+        m_db.storage().readPage(
+            n++ % 2 ? nextPageRange() : pageRange(), recDir, tagDir);
+    }
+}
+
+void Benchmarks::pageSwitchAllocations_data()
+{
+    QTest::addColumn<bool>("bytes");
+
+    QTest::newRow("allocations") << false;
+    QTest::newRow("bytes") << true;
+}
+
+// heap usage of one page switch, after both pages were visited once
+void Benchmarks::pageSwitchAllocations()
+{
+    QFETCH(bool, bytes);
+
+    models::RecordsDirectory recDir;
+    models::TagsDirectory tagDir;
+
+    QVERIFY(m_db.storage().readPage(pageRange(), recDir, tagDir));
+
+    recDir.clearRecords();
+    tagDir.releaseUnusedTags();
+    QVERIFY(m_db.storage().readPage(nextPageRange(), recDir, tagDir));
+
+    const auto before = allocStats();
+
+    recDir.clearRecords();
+    tagDir.releaseUnusedTags();
+    QVERIFY(m_db.storage().readPage(pageRange(), recDir, tagDir));
+
+    const auto after = allocStats();
+
+    if (bytes) {
+        QTest::setBenchmarkResult(
+            qreal(after.bytes - before.bytes), QTest::BytesAllocated);
+    } else {
+        QTest::setBenchmarkResult(qreal(after.count - before.count), QTest::Events);
+    }
+}
+
+void Benchmarks::rebuildCell()
+{
+    models::Root root;
+    presenters::CalendarArea calendarArea(m_db.storage(), root);
+
+    calendarArea.resize(1200, 900);
+    calendarArea.showDate(pageRange().first.addDays(14));
+
+    auto record = findRecord(root.currentPage());
+    QVERIFY(record);
+
+    auto tags = record->tags();
+
+    auto fewerTags = tags;
+    fewerTags.removeLast();
+
+    int n = 0;
+
+    // every change of record tags rebuilds its calendar cell
+    QBENCHMARK
+    {
+        record->setTags(n++ % 2 ? tags : fewerTags);
+    }
+}
+
+void Benchmarks::flowLayout()
+{
+    QWidget widget;
+    auto layout = new widgets::FlowLayout(&widget);
+
+    for (int n = 0; n < 100; n++) {
+        auto label = new widgets::TagLabel;
+        label->setText(QString("tag%1").arg(n));
+        layout->addWidget(label);
+    }
+
+    int n = 0;
+
+    QBENCHMARK
+    {
+        layout->setGeometry(QRect(0, 0, n++ % 2 ? 300 : 400, 1000));
+    }
+}
+
+void Benchmarks::paintTagLabel_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("cached") << true;
+    QTest::newRow("uncached") << false;
+}
+
+void Benchmarks::paintTagLabel()
+{
+    QFETCH(bool, cached);
+
+    widgets::TagLabel label;
+    label.setText("benchmark");
+    label.setCustomIndicator("3");
+
+    QPixmap pixmap(label.size());
+    int n = 0;
+
+    QBENCHMARK
+    {
+        if (!cached) {
+            // invalidates pixmap cache of label
+            label.setComplete(n++ % 2 == 1);
+        }
+        label.render(&pixmap);
+    }
+}
+
+void Benchmarks::updateMarkdownText()
+{
+    widgets::MarkdownEdit edit;
+    edit.resize(400, 300);
+
+    const QString texts[] = {
+        gen::makeDescription(m_config.descriptionLength, 1),
+        gen::makeDescription(m_config.descriptionLength, 2),
+    };
+
+    int n = 0;
+
+    QBENCHMARK
+    {
+        edit.setText(texts[n++ % 2]);
+    }
+}
+
+} // namespace tagberry::bench
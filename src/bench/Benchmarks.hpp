@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "bench/BenchDB.hpp"
+#include "models/Root.hpp"
+
+#include <QObject>
+
+namespace tagberry::bench {
+
+class Benchmarks : public QObject {
+    Q_OBJECT
+
+public:
+    explicit Benchmarks(const BenchConfig& config);
+
+private slots:
+    void initTestCase();
+
+    // storage
+    void readPage();
+    void saveRecord();
+
+    // models
+    void populateRecordsDirectory();
+    void getAllTags();
+    void switchPage();
+    void pageSwitchAllocations_data();
+    void pageSwitchAllocations();
+
+    // presenters and widgets
+    void rebuildCell();
+    void flowLayout();
+    void paintTagLabel_data();
+    void paintTagLabel();
+    void updateMarkdownText();
+
+private:
+    QPair<QDate, QDate> pageRange() const;
+    QPair<QDate, QDate> nextPageRange() const;
+    models::RecordPtr findRecord(models::RecordsDirectory& recDir) const;
+
+    BenchConfig m_config;
+    BenchDB m_db;
+};
+
+} // namespace tagberry::bench
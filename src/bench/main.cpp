@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "bench/Benchmarks.hpp"
+
+#include <QApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryFile>
+#include <QXmlStreamReader>
+#include <QtTest>
+
+#include <iostream>
+
+namespace {
+
+// QtTest has no JSON output, so its XML report is converted
+bool writeJSON(const QString& xmlPath, const QString& jsonPath,
+    const tagberry::bench::BenchConfig& config)
+{
+    QFile xmlFile(xmlPath);
+    if (!xmlFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonArray results;
+    QString function;
+
+    QXmlStreamReader xml(&xmlFile);
+    while (!xml.atEnd()) {
+        if (!xml.readNextStartElement()) {
+            continue;
+        }
+
+        const auto attrs = xml.attributes();
+
+        if (xml.name() == QLatin1String("TestFunction")) {
+            function = attrs.value("name").toString();
+        } else if (xml.name() == QLatin1String("BenchmarkResult")) {
+            results.append(QJsonObject {
+                { "name", function },
+                { "tag", attrs.value("tag").toString() },
+                { "metric", attrs.value("metric").toString() },
+                { "value", attrs.value("value").toDouble() },
+                { "iterations", attrs.value("iterations").toInt() },
+            });
+        }
+    }
+
+    if (xml.hasError()) {
+        std::cerr << "can't parse benchmark results: " << xml.errorString().toStdString()
+                  << "\n";
+        return false;
+    }
+
+    QJsonObject root {
+        { "config",
+            QJsonObject {
+                { "days", config.days },
+                { "records_per_day", config.recordsPerDay },
+                { "tags", config.tags },
+                { "tags_per_record", config.tagsPerRecord },
+                { "description_length", config.descriptionLength },
+            } },
+        { "results", results },
+    };
+
+    QFile jsonFile(jsonPath);
+    if (!jsonFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    jsonFile.write(QJsonDocument(root).toJson());
+
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // widgets are painted without display
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+
+    auto args = app.arguments();
+
+    tagberry::bench::BenchConfig config;
+    if (!config.parse(args)) {
+        std::cerr << "usage: tagberry-bench [--days=N] [--records-per-day=N] [--tags=N]"
+                     " [--tags-per-record=N] [--description-length=N] [--json=FILE]"
+                     " [QtTest options]\n";
+        return 1;
+    }
+
+    QString jsonPath;
+    for (auto it = args.begin(); it != args.end(); ++it) {
+        if (it->startsWith("--json=")) {
+            jsonPath = it->mid(7);
+            args.erase(it);
+            break;
+        }
+    }
+
+    QTemporaryFile xmlFile;
+    if (!jsonPath.isEmpty()) {
+        if (!xmlFile.open()) {
+            std::cerr << "can't create temporary file\n";
+            return 1;
+        }
+        xmlFile.close();
+
+        args << "-o" << xmlFile.fileName() + ",xml" << "-o" << "-,txt";
+    }
+
+    tagberry::bench::Benchmarks benchmarks(config);
+
+    const int code = QTest::qExec(&benchmarks, args);
+
+    if (!jsonPath.isEmpty() && !writeJSON(xmlFile.fileName(), jsonPath, config)) {
+        std::cerr << "can't write " << jsonPath.toStdString() << "\n";
+        return 1;
+    }
+
+    return code;
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "gen/Generator.hpp"
+#include "storage/BulkWriter.hpp"
+
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace tagberry::gen {
+
+namespace {
+
+const char* const words[] = { "lorem", "ipsum", "dolor", "sit", "amet", "consectetur",
+    "adipiscing", "elit", "sed", "do", "eiusmod", "tempor", "incididunt", "ut",
+    "labore", "et", "dolore", "magna", "aliqua" };
+
+const unsigned numWords = sizeof(words) / sizeof(words[0]);
+
+template <class Rng> void appendDescription(QString& text, int length, Rng& rng)
+{
+    while (text.size() < length) {
+        switch (rng() % 8) {
+        case 0:
+            text += "\n## ";
+            break;
+        case 1:
+            text += "\n- ";
+            break;
+        case 2:
+            text += " **";
+            text += words[rng() % numWords];
+            text += "**";
+            break;
+        case 3:
+            text += " `code`";
+            break;
+        default:
+            text += ' ';
+            break;
+        }
+        text += words[rng() % numWords];
+    }
+}
+
+// samples rank in [0; n) with probability proportional to 1 / (rank + 1)^s
+class ZipfDistribution {
+public:
+    ZipfDistribution(int n, double s)
+    {
+        double sum = 0;
+        m_cdf.reserve(size_t(std::max(n, 0)));
+        for (int k = 1; k <= n; k++) {
+            sum += 1 / std::pow(k, s);
+            m_cdf.push_back(sum);
+        }
+        for (auto& p : m_cdf) {
+            p /= sum;
+        }
+    }
+
+    template <class Rng> int operator()(Rng& rng)
+    {
+        const auto u = std::uniform_real_distribution<double>()(rng);
+        auto it = std::lower_bound(m_cdf.begin(), m_cdf.end(), u);
+        return int(std::min(it - m_cdf.begin(), std::ptrdiff_t(m_cdf.size()) - 1));
+    }
+
+private:
+    std::vector<double> m_cdf;
+};
+
+} // namespace
+
+QString makeDescription(int length, unsigned seed)
+{
+    std::mt19937 rng(seed);
+
+    QString text;
+    text.reserve(length + 16);
+
+    appendDescription(text, length, rng);
+
+    return text;
+}
+
+Generator::Generator(const GeneratorConfig& config)
+    : m_config(config)
+{
+}
+
+void Generator::setProgressHandler(std::function<void(int, qint64)> handler)
+{
+    m_progress = std::move(handler);
+}
+
+bool Generator::run()
+{
+    std::mt19937 rng(m_config.seed);
+
+    // poisson distribution needs positive mean, zero means are checked on use
+    std::poisson_distribution<int> recordsPerDay(
+        m_config.recordsPerDay > 0 ? m_config.recordsPerDay : 1);
+    std::poisson_distribution<int> tagsPerRecord(
+        m_config.tagsPerRecord > 0 ? m_config.tagsPerRecord : 1);
+    std::exponential_distribution<double> descriptionLength(
+        m_config.descriptionLength > 0 ? 1.0 / m_config.descriptionLength : 1.0);
+    std::bernoulli_distribution complete(m_config.completeRatio);
+
+    ZipfDistribution tagRank(m_config.tags, m_config.zipfExponent);
+
+    storage::BulkWriter writer;
+
+    // always a fresh file, rerun generator if anything goes wrong
+    writer.setDurable(false);
+
+    if (!writer.begin()) {
+        return false;
+    }
+
+    QVector<quint32> tagIDs;
+    tagIDs.reserve(m_config.tags);
+
+    for (int n = 0; n < m_config.tags; n++) {
+        quint32 id {};
+        if (!writer.addTag(QString("tag%1").arg(n), id)) {
+            writer.rollback();
+            return false;
+        }
+        tagIDs.append(id);
+    }
+
+    qint64 recordCount = 0;
+
+    QString title;
+    QString description;
+    QVector<quint32> recordTags;
+
+    for (int day = 0; day < m_config.days; day++) {
+        const auto date = m_config.startDate.addDays(day);
+        const int numRecords = m_config.recordsPerDay > 0 ? recordsPerDay(rng) : 0;
+
+        for (int n = 0; n < numRecords; n++) {
+            title = QString("record %1 of %2").arg(n).arg(date.toString(Qt::ISODate));
+
+            description.clear();
+            if (m_config.descriptionLength > 0) {
+                appendDescription(description, int(descriptionLength(rng)), rng);
+            }
+
+            recordTags.clear();
+            if (!tagIDs.isEmpty() && m_config.tagsPerRecord > 0) {
+                const int numTags = std::min(tagsPerRecord(rng), tagIDs.size());
+                // duplicates are dropped, popular tags may give less tags than drawn
+                for (int t = 0; t < numTags; t++) {
+                    const auto tagID = tagIDs[tagRank(rng)];
+                    if (!recordTags.contains(tagID)) {
+                        recordTags.append(tagID);
+                    }
+                }
+            }
+
+            quint32 id {};
+            if (!writer.addRecord(date, complete(rng), title, description, recordTags, id)) {
+                writer.rollback();
+                return false;
+            }
+
+            recordCount++;
+        }
+
+        if (m_progress) {
+            m_progress(day + 1, recordCount);
+        }
+    }
+
+    return writer.commit();
+}
+
+} // namespace tagberry::gen
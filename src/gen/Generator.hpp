@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QDate>
+#include <QString>
+
+#include <functional>
+
+namespace tagberry::gen {
+
+struct GeneratorConfig {
+    QDate startDate { 2020, 1, 1 };
+    int days { 730 };
+
+    // mean values of poisson distributions
+    double recordsPerDay { 3 };
+    double tagsPerRecord { 3 };
+
+    // tag popularity follows zipf law with given exponent
+    int tags { 200 };
+    double zipfExponent { 1 };
+
+    // mean of exponential distribution, 0 for no descriptions
+    int descriptionLength { 400 };
+
+    double completeRatio { 0.7 };
+
+    unsigned seed { 1 };
+};
+
+// Fills opened storage with pseudo-random records, deterministic for given
+// config.
+class Generator {
+public:
+    explicit Generator(const GeneratorConfig& config);
+
+    // called after each generated day
+    void setProgressHandler(std::function<void(int day, qint64 records)>);
+
+    bool run();
+
+private:
+    GeneratorConfig m_config;
+    std::function<void(int, qint64)> m_progress;
+};
+
+// markdown text of roughly given length
+QString makeDescription(int length, unsigned seed);
+
+} // namespace tagberry::gen
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "gen/Generator.hpp"
+#include "storage/LocalStorage.hpp"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <iostream>
+
+namespace {
+
+void nullOutput(QtMsgType, const QMessageLogContext&, const QString&)
+{
+    return;
+}
+
+void stderrOutput(QtMsgType type, const QMessageLogContext&, const QString& msg)
+{
+    if (type != QtDebugMsg) {
+        std::cerr << msg.toStdString() << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    qInstallMessageHandler(nullOutput);
+
+    QCoreApplication app(argc, argv);
+
+    app.setApplicationName("tagberry-gen");
+
+    tagberry::gen::GeneratorConfig config;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generates Tagberry DB with random records");
+
+    QCommandLineOption helpOpt({ "h", "help" }, "Display help.");
+    parser.addOption(helpOpt);
+
+    QCommandLineOption dbOpt("db", "Path of new DB.", "db");
+    parser.addOption(dbOpt);
+
+    QCommandLineOption startOpt(
+        "start", "First day, YYYY-MM-DD.", "date", config.startDate.toString(Qt::ISODate));
+    parser.addOption(startOpt);
+
+    QCommandLineOption daysOpt("days", "Number of days.", "n", QString::number(config.days));
+    parser.addOption(daysOpt);
+
+    QCommandLineOption recordsOpt("records-per-day", "Mean records per day.", "n",
+        QString::number(config.recordsPerDay));
+    parser.addOption(recordsOpt);
+
+    QCommandLineOption tagsPerRecordOpt("tags-per-record", "Mean tags per record.", "n",
+        QString::number(config.tagsPerRecord));
+    parser.addOption(tagsPerRecordOpt);
+
+    QCommandLineOption tagsOpt(
+        "tags", "Tag vocabulary size.", "n", QString::number(config.tags));
+    parser.addOption(tagsOpt);
+
+    QCommandLineOption zipfOpt("zipf", "Zipf exponent of tag popularity.", "s",
+        QString::number(config.zipfExponent));
+    parser.addOption(zipfOpt);
+
+    QCommandLineOption descOpt("description-length", "Mean description length.", "n",
+        QString::number(config.descriptionLength));
+    parser.addOption(descOpt);
+
+    QCommandLineOption completeOpt("complete-ratio", "Ratio of complete records.", "p",
+        QString::number(config.completeRatio));
+    parser.addOption(completeOpt);
+
+    QCommandLineOption seedOpt(
+        "seed", "Random seed.", "n", QString::number(config.seed));
+    parser.addOption(seedOpt);
+
+    if (!parser.parse(app.arguments())) {
+        std::cerr << parser.errorText().toStdString() << "\n";
+        return 1;
+    }
+
+    if (parser.isSet(helpOpt) || !parser.isSet(dbOpt)) {
+        std::cerr << parser.helpText().toStdString();
+        return parser.isSet(helpOpt) ? 0 : 1;
+    }
+
+    bool ok = true;
+    auto check = [&](bool valid) { ok = ok && valid; };
+
+    config.startDate = QDate::fromString(parser.value(startOpt), Qt::ISODate);
+    check(config.startDate.isValid());
+
+    bool v = false;
+    config.days = parser.value(daysOpt).toInt(&v);
+    check(v && config.days >= 0);
+    config.recordsPerDay = parser.value(recordsOpt).toDouble(&v);
+    check(v && config.recordsPerDay >= 0);
+    config.tagsPerRecord = parser.value(tagsPerRecordOpt).toDouble(&v);
+    check(v && config.tagsPerRecord >= 0);
+    config.tags = parser.value(tagsOpt).toInt(&v);
+    check(v && config.tags >= 0);
+    config.zipfExponent = parser.value(zipfOpt).toDouble(&v);
+    check(v && config.zipfExponent >= 0);
+    config.descriptionLength = parser.value(descOpt).toInt(&v);
+    check(v && config.descriptionLength >= 0);
+    config.completeRatio = parser.value(completeOpt).toDouble(&v);
+    check(v && config.completeRatio >= 0 && config.completeRatio <= 1);
+    config.seed = parser.value(seedOpt).toUInt(&v);
+    check(v);
+
+    if (!ok) {
+        std::cerr << "invalid option value\n";
+        return 1;
+    }
+
+    const auto path = parser.value(dbOpt);
+
+    if (QFile::exists(path)) {
+        std::cerr << path.toStdString() << " already exists\n";
+        return 1;
+    }
+
+    qInstallMessageHandler(stderrOutput);
+
+    tagberry::storage::LocalStorage storage;
+
+    if (!storage.open(path)) {
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    tagberry::gen::Generator generator(config);
+
+    generator.setProgressHandler([&](int day, qint64 records) {
+        if (day % 365 == 0 || day == config.days) {
+            std::cerr << day << "/" << config.days << " days, " << records
+                      << " records\n";
+        }
+    });
+
+    if (!generator.run()) {
+        return 1;
+    }
+
+    std::cerr << "done in " << timer.elapsed() << " ms\n";
+
+    return 0;
+}
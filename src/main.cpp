@@ -8,18 +8,25 @@
  */
 
 #include "presenters/MainWindow.hpp"
+#include "storage/Exporter.hpp"
+#include "storage/Importer.hpp"
 #include "storage/LocalStorage.hpp"
+#include "trace/Trace.hpp"
 
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QDate>
 #include <QDebug>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
 #include <QIcon>
 #include <QStandardPaths>
+#include <QTextStream>
 #include <QTime>
 
 #include <iostream>
+#include <memory>
 
 namespace {
 
@@ -75,6 +82,15 @@ void stderrOutput(QtMsgType type, const QMessageLogContext& context, const QStri
     std::cerr << line.toStdString();
 }
 
+// query output is read by scripts, keep only problems on stderr
+void quietOutput(QtMsgType type, const QMessageLogContext& context, const QString& msg)
+{
+    if (type == QtDebugMsg || type == QtInfoMsg) {
+        return;
+    }
+    stderrOutput(type, context, msg);
+}
+
 QString defaultDBPath()
 {
     auto config = QStandardPaths::writableLocation(QStandardPaths::ConfigLocation);
@@ -84,16 +100,211 @@ QString defaultDBPath()
     return QDir(QDir::homePath()).filePath(".tagberry-qt");
 }
 
+// modes that don't open window and can run without display
+const char* const headlessOptions[] = { "export", "import", "query" };
+
+// checked before QCoreApplication is created, so parser can't be used
+bool isHeadless(int argc, char** argv)
+{
+    for (int n = 1; n < argc; n++) {
+        const auto arg = QString::fromLocal8Bit(argv[n]);
+
+        for (auto name : headlessOptions) {
+            const auto opt = QString("--") + name;
+            if (arg == opt || arg.startsWith(opt + "=")) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int runExport(const QString& dbPath, const QString& outPath, QString format)
+{
+    if (format.isEmpty()) {
+        format = outPath.endsWith(".csv", Qt::CaseInsensitive) ? "csv" : "jsonl";
+    }
+
+    if (format != "csv" && format != "jsonl") {
+        qCritical() << "unknown export format" << format;
+        return 1;
+    }
+
+    tagberry::storage::LocalStorage storage;
+
+    if (!storage.openReadOnly(dbPath)) {
+        return 1;
+    }
+
+    QFile out;
+    bool opened;
+
+    if (outPath == "-") {
+        opened = out.open(stdout, QIODevice::WriteOnly);
+    } else {
+        out.setFileName(outPath);
+        opened = out.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+
+    if (!opened) {
+        qCritical() << "can't open" << outPath << "for writing";
+        return 1;
+    }
+
+    tagberry::storage::Exporter exporter(format == "csv"
+            ? tagberry::storage::Exporter::Format::Csv
+            : tagberry::storage::Exporter::Format::Jsonl);
+
+    if (!exporter.write(out)) {
+        return 1;
+    }
+
+    qInfo() << "exported" << exporter.recordCount() << "records";
+
+    return 0;
+}
+
+int runImport(
+    const QString& dbPath, const QString& inPath, QString format, const QDate& date)
+{
+    if (format.isEmpty()) {
+        format = inPath.endsWith(".csv", Qt::CaseInsensitive) ? "csv" : "markdown";
+    }
+
+    if (format != "csv" && format != "markdown") {
+        qCritical() << "unknown import format" << format;
+        return 1;
+    }
+
+    tagberry::storage::LocalStorage storage;
+
+    if (!storage.open(dbPath)) {
+        return 1;
+    }
+
+    // backup before big write is never postponed
+    if (!storage.runMaintenance()) {
+        return 1;
+    }
+
+    tagberry::storage::Importer importer(inPath,
+        format == "csv" ? tagberry::storage::Importer::Format::Csv
+                        : tagberry::storage::Importer::Format::Markdown);
+
+    importer.setDefaultDate(date);
+
+    importer.setProgressHandler([](qint64 records, qint64 position, qint64 size) {
+        std::cerr << records << " records, " << (size ? position * 100 / size : 100)
+                  << "%\n";
+    });
+
+    if (!importer.run()) {
+        return 1;
+    }
+
+    if (importer.skippedRecords() != 0) {
+        qWarning() << importer.skippedRecords() << "records without date skipped,"
+                   << "use --import-date to import them";
+    }
+
+    qInfo() << "import complete";
+
+    return 0;
+}
+
+// YYYY-MM-DD, "today", or offset in days from today like -7
+bool parseDay(const QString& str, QDate& day)
+{
+    if (str.isEmpty()) {
+        day = QDate();
+        return true;
+    }
+
+    if (str == "today") {
+        day = QDate::currentDate();
+        return true;
+    }
+
+    bool isOffset = false;
+    const int offset = str.toInt(&isOffset);
+
+    if (isOffset) {
+        day = QDate::currentDate().addDays(offset);
+        return true;
+    }
+
+    day = QDate::fromString(str, Qt::ISODate);
+
+    if (!day.isValid()) {
+        qCritical() << "can't parse date" << str;
+        return false;
+    }
+
+    return true;
+}
+
+int runQuery(const QString& dbPath, const QStringList& tags, const QString& from,
+    const QString& to, const QString& state)
+{
+    tagberry::storage::RecordFilter filter;
+
+    filter.tags = tags;
+
+    if (!parseDay(from, filter.from) || !parseDay(to, filter.to)) {
+        return 1;
+    }
+
+    if (state == "open") {
+        filter.state = tagberry::storage::RecordFilter::State::Open;
+    } else if (state == "complete") {
+        filter.state = tagberry::storage::RecordFilter::State::Complete;
+    } else if (state != "all") {
+        qCritical() << "unknown record state" << state;
+        return 1;
+    }
+
+    tagberry::storage::LocalStorage storage;
+
+    if (!storage.openReadOnly(dbPath)) {
+        return 1;
+    }
+
+    QTextStream out(stdout);
+
+    const bool ok = storage.findRecords(filter, [&](const auto& row) {
+        out << row.date.toString(Qt::ISODate) << (row.complete ? " [x] " : " [ ] ")
+            << row.title;
+
+        for (const auto& tag : row.tags) {
+            out << " #" << tag;
+        }
+
+        out << '\n';
+    });
+
+    out.flush();
+
+    return ok ? 0 : 1;
+}
+
 } // namespace
 
 int main(int argc, char** argv)
 {
+    tagberry::trace::beginStartup();
+
     qInstallMessageHandler(nullOutput);
 
-    QApplication app(argc, argv);
+    std::unique_ptr<QCoreApplication> app;
 
-    app.setApplicationName("tagberry-qt");
-    app.setWindowIcon(QIcon(":/icons/app.png"));
+    if (isHeadless(argc, argv)) {
+        app = std::make_unique<QCoreApplication>(argc, argv);
+    } else {
+        app = std::make_unique<QApplication>(argc, argv);
+        QApplication::setWindowIcon(QIcon(":/icons/app.png"));
+    }
+
+    app->setApplicationName("tagberry-qt");
 
     QCommandLineParser parser;
     parser.setApplicationDescription("Tagberry Qt5 desktop app");
@@ -104,7 +315,66 @@ int main(int argc, char** argv)
     QCommandLineOption dbOpt("db", "DB path.", "db", defaultDBPath());
     parser.addOption(dbOpt);
 
-    if (!parser.parse(app.arguments())) {
+    QCommandLineOption traceOpt("trace", "Write Chrome trace to file.", "file");
+    parser.addOption(traceOpt);
+
+    QCommandLineOption startupProfileOpt(
+        "startup-profile", "Print wall time of startup phases.");
+    parser.addOption(startupProfileOpt);
+
+    QCommandLineOption validateSchemaOpt(
+        "validate-schema", "Compare DB schema with migrations on startup.");
+    parser.addOption(validateSchemaOpt);
+
+    QCommandLineOption exportOpt(
+        "export", "Export all records to file (- for stdout) and exit.", "file");
+    parser.addOption(exportOpt);
+
+    QCommandLineOption exportFormatOpt("export-format",
+        "Export format, jsonl or csv; guessed from file extension by default.",
+        "format");
+    parser.addOption(exportFormatOpt);
+
+    QCommandLineOption importOpt("import",
+        "Import records from file and exit; interrupted import is resumed.", "file");
+    parser.addOption(importOpt);
+
+    QCommandLineOption importFormatOpt("import-format",
+        "Import format, csv or markdown; csv for .csv files by default.", "format");
+    parser.addOption(importFormatOpt);
+
+    QCommandLineOption importDateOpt("import-date",
+        "Day of imported records having none: YYYY-MM-DD, today, or offset in days"
+        " like -7; such records are skipped by default.",
+        "day");
+    parser.addOption(importDateOpt);
+
+    QCommandLineOption queryOpt("query",
+        "Print records matching --tag, --from, --to and --state and exit.");
+    parser.addOption(queryOpt);
+
+    QCommandLineOption tagOpt(
+        "tag", "Query records having tag; may be repeated to require all tags.", "name");
+    parser.addOption(tagOpt);
+
+    QCommandLineOption fromOpt("from",
+        "Query records since day: YYYY-MM-DD, today, or offset in days like -7.",
+        "day");
+    parser.addOption(fromOpt);
+
+    QCommandLineOption toOpt("to", "Query records until day, inclusive.", "day");
+    parser.addOption(toOpt);
+
+    QCommandLineOption stateOpt(
+        "state", "Query records in state: open, complete, or all.", "state", "all");
+    parser.addOption(stateOpt);
+
+    QCommandLineOption serverOpt("server",
+        "Local socket name for requests from scripts to running app.", "name",
+        "tagberry-qt");
+    parser.addOption(serverOpt);
+
+    if (!parser.parse(app->arguments())) {
         std::cerr << parser.errorText().toStdString();
         return 1;
     }
@@ -114,11 +384,48 @@ int main(int argc, char** argv)
         return 0;
     }
 
+    if (parser.isSet(queryOpt)) {
+        qInstallMessageHandler(quietOutput);
+
+        return runQuery(parser.value(dbOpt), parser.values(tagOpt),
+            parser.value(fromOpt), parser.value(toOpt), parser.value(stateOpt));
+    }
+
     qInstallMessageHandler(stderrOutput);
 
+    if (parser.isSet(traceOpt) && !tagberry::trace::start(parser.value(traceOpt))) {
+        return 1;
+    }
+
+    if (parser.isSet(exportOpt)) {
+        int code = runExport(parser.value(dbOpt), parser.value(exportOpt),
+            parser.value(exportFormatOpt));
+
+        tagberry::trace::stop();
+
+        return code;
+    }
+
+    if (parser.isSet(importOpt)) {
+        QDate importDate;
+
+        if (!parseDay(parser.value(importDateOpt), importDate)) {
+            return 1;
+        }
+
+        int code = runImport(parser.value(dbOpt), parser.value(importOpt),
+            parser.value(importFormatOpt), importDate);
+
+        tagberry::trace::stop();
+
+        return code;
+    }
+
+    tagberry::trace::markPhase("qt init");
+
     tagberry::storage::LocalStorage storage;
 
-    if (!storage.open(parser.value(dbOpt))) {
+    if (!storage.open(parser.value(dbOpt), parser.isSet(validateSchemaOpt))) {
         return 1;
     }
 
@@ -126,9 +433,41 @@ int main(int argc, char** argv)
 
     tagberry::presenters::MainWindow window(storage);
 
+    tagberry::trace::markPhase("main window");
+
     window.show();
 
-    int code = app.exec();
+    tagberry::trace::markPhase("show window");
+
+    // everything not needed to draw first page is done after it is on screen
+    QObject::connect(&window, &tagberry::presenters::MainWindow::firstPainted, [&] {
+        tagberry::trace::markPhase("first paint");
+
+        window.loadDeferred();
+        tagberry::trace::markPhase("load tags");
+
+        // backup is copied in background, session goes on if it fails
+        QObject::connect(&storage,
+            &tagberry::storage::LocalStorage::maintenanceFinished, [](bool ok) {
+                if (!ok) {
+                    qWarning() << "maintenance failed, no fresh backup";
+                }
+            });
+
+        storage.startMaintenance();
+
+        storage.watchExternalChanges();
+
+        window.listenScripts(parser.value(serverOpt));
+
+        if (parser.isSet(startupProfileOpt)) {
+            tagberry::trace::printStartupProfile();
+        }
+    });
+
+    int code = app->exec();
+
+    tagberry::trace::stop();
 
     qDebug() << "exiting with code" << code;
 
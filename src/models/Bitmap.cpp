@@ -0,0 +1,425 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "models/Bitmap.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace tagberry::models {
+
+namespace {
+
+int popCount(quint64 word)
+{
+    return int(std::bitset<64>(word).count());
+}
+
+} // namespace
+
+bool Bitmap::Container::isBitset() const
+{
+    return !bits.empty();
+}
+
+bool Bitmap::Container::contains(quint16 low) const
+{
+    if (isBitset()) {
+        return (bits[low >> 6] >> (low & 63)) & 1;
+    }
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void Bitmap::Container::toBitset()
+{
+    bits.assign(BitsetWords, 0);
+    for (auto low : array) {
+        bits[low >> 6] |= quint64(1) << (low & 63);
+    }
+    array.clear();
+    array.shrink_to_fit();
+}
+
+void Bitmap::Container::toArray()
+{
+    std::vector<quint16> values;
+    values.reserve(size_t(cardinality));
+
+    for (int n = 0; n < BitsetWords; n++) {
+        auto word = bits[size_t(n)];
+        while (word) {
+            const auto lowest = word & (~word + 1);
+            values.push_back(quint16((n << 6) | popCount(lowest - 1)));
+            word ^= lowest;
+        }
+    }
+
+    array.swap(values);
+    bits.clear();
+    bits.shrink_to_fit();
+}
+
+void Bitmap::Container::normalize()
+{
+    if (isBitset() && cardinality <= MaxArraySize) {
+        toArray();
+    } else if (!isBitset() && cardinality > MaxArraySize) {
+        toBitset();
+    }
+}
+
+bool Bitmap::Container::operator==(const Container& other) const
+{
+    return key == other.key && cardinality == other.cardinality && array == other.array
+        && bits == other.bits;
+}
+
+std::vector<Bitmap::Container>::iterator Bitmap::findContainer(quint16 key)
+{
+    return std::lower_bound(m_containers.begin(), m_containers.end(), key,
+        [](const Container& c, quint16 k) { return c.key < k; });
+}
+
+std::vector<Bitmap::Container>::const_iterator Bitmap::findContainer(quint16 key) const
+{
+    return std::lower_bound(m_containers.begin(), m_containers.end(), key,
+        [](const Container& c, quint16 k) { return c.key < k; });
+}
+
+bool Bitmap::isEmpty() const
+{
+    return m_containers.empty();
+}
+
+quint64 Bitmap::count() const
+{
+    quint64 ret = 0;
+    for (const auto& c : m_containers) {
+        ret += quint64(c.cardinality);
+    }
+    return ret;
+}
+
+bool Bitmap::contains(quint32 value) const
+{
+    const auto key = quint16(value >> 16);
+
+    auto it = findContainer(key);
+    if (it == m_containers.end() || it->key != key) {
+        return false;
+    }
+
+    return it->contains(quint16(value & 0xffff));
+}
+
+void Bitmap::add(quint32 value)
+{
+    const auto key = quint16(value >> 16);
+    const auto low = quint16(value & 0xffff);
+
+    auto it = findContainer(key);
+    if (it == m_containers.end() || it->key != key) {
+        it = m_containers.insert(it, Container());
+        it->key = key;
+    }
+
+    if (it->isBitset()) {
+        auto& word = it->bits[low >> 6];
+        const auto mask = quint64(1) << (low & 63);
+        if (!(word & mask)) {
+            word |= mask;
+            it->cardinality++;
+        }
+        return;
+    }
+
+    auto pos = std::lower_bound(it->array.begin(), it->array.end(), low);
+    if (pos != it->array.end() && *pos == low) {
+        return;
+    }
+
+    it->array.insert(pos, low);
+    it->cardinality++;
+    it->normalize();
+}
+
+void Bitmap::remove(quint32 value)
+{
+    const auto key = quint16(value >> 16);
+    const auto low = quint16(value & 0xffff);
+
+    auto it = findContainer(key);
+    if (it == m_containers.end() || it->key != key) {
+        return;
+    }
+
+    if (it->isBitset()) {
+        auto& word = it->bits[low >> 6];
+        const auto mask = quint64(1) << (low & 63);
+        if (!(word & mask)) {
+            return;
+        }
+        word &= ~mask;
+        it->cardinality--;
+    } else {
+        auto pos = std::lower_bound(it->array.begin(), it->array.end(), low);
+        if (pos == it->array.end() || *pos != low) {
+            return;
+        }
+        it->array.erase(pos);
+        it->cardinality--;
+    }
+
+    if (it->cardinality == 0) {
+        m_containers.erase(it);
+    } else {
+        it->normalize();
+    }
+}
+
+void Bitmap::clear()
+{
+    m_containers.clear();
+}
+
+Bitmap::Container Bitmap::intersectContainers(const Container& a, const Container& b)
+{
+    Container ret;
+    ret.key = a.key;
+
+    if (!a.isBitset() && !b.isBitset()) {
+        std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(),
+            b.array.end(), std::back_inserter(ret.array));
+        ret.cardinality = int(ret.array.size());
+        return ret;
+    }
+
+    if (!a.isBitset() || !b.isBitset()) {
+        const auto& arr = a.isBitset() ? b : a;
+        const auto& set = a.isBitset() ? a : b;
+        for (auto low : arr.array) {
+            if (set.contains(low)) {
+                ret.array.push_back(low);
+            }
+        }
+        ret.cardinality = int(ret.array.size());
+        return ret;
+    }
+
+    ret.bits.resize(BitsetWords);
+    for (size_t n = 0; n < BitsetWords; n++) {
+        ret.bits[n] = a.bits[n] & b.bits[n];
+        ret.cardinality += popCount(ret.bits[n]);
+    }
+    ret.normalize();
+    return ret;
+}
+
+Bitmap::Container Bitmap::uniteContainers(const Container& a, const Container& b)
+{
+    Container ret;
+    ret.key = a.key;
+
+    if (!a.isBitset() && !b.isBitset()) {
+        std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+            std::back_inserter(ret.array));
+        ret.cardinality = int(ret.array.size());
+        ret.normalize();
+        return ret;
+    }
+
+    ret.bits.assign(BitsetWords, 0);
+    for (const auto* c : { &a, &b }) {
+        if (c->isBitset()) {
+            for (size_t n = 0; n < BitsetWords; n++) {
+                ret.bits[n] |= c->bits[n];
+            }
+        } else {
+            for (auto low : c->array) {
+                ret.bits[low >> 6] |= quint64(1) << (low & 63);
+            }
+        }
+    }
+    for (auto word : ret.bits) {
+        ret.cardinality += popCount(word);
+    }
+    ret.normalize();
+    return ret;
+}
+
+Bitmap::Container Bitmap::subtractContainers(const Container& a, const Container& b)
+{
+    Container ret;
+    ret.key = a.key;
+
+    if (!a.isBitset()) {
+        for (auto low : a.array) {
+            if (!b.contains(low)) {
+                ret.array.push_back(low);
+            }
+        }
+        ret.cardinality = int(ret.array.size());
+        return ret;
+    }
+
+    ret.bits = a.bits;
+    if (b.isBitset()) {
+        for (size_t n = 0; n < BitsetWords; n++) {
+            ret.bits[n] &= ~b.bits[n];
+        }
+    } else {
+        for (auto low : b.array) {
+            ret.bits[low >> 6] &= ~(quint64(1) << (low & 63));
+        }
+    }
+    for (auto word : ret.bits) {
+        ret.cardinality += popCount(word);
+    }
+    ret.normalize();
+    return ret;
+}
+
+Bitmap& Bitmap::intersect(const Bitmap& other)
+{
+    std::vector<Container> result;
+
+    auto a = m_containers.begin();
+    auto b = other.m_containers.begin();
+
+    while (a != m_containers.end() && b != other.m_containers.end()) {
+        if (a->key < b->key) {
+            ++a;
+        } else if (b->key < a->key) {
+            ++b;
+        } else {
+            auto c = intersectContainers(*a, *b);
+            if (c.cardinality) {
+                result.push_back(std::move(c));
+            }
+            ++a;
+            ++b;
+        }
+    }
+
+    m_containers.swap(result);
+    return *this;
+}
+
+Bitmap& Bitmap::unite(const Bitmap& other)
+{
+    std::vector<Container> result;
+    result.reserve(m_containers.size() + other.m_containers.size());
+
+    auto a = m_containers.begin();
+    auto b = other.m_containers.begin();
+
+    while (a != m_containers.end() || b != other.m_containers.end()) {
+        if (b == other.m_containers.end() || (a != m_containers.end() && a->key < b->key)) {
+            result.push_back(std::move(*a));
+            ++a;
+        } else if (a == m_containers.end() || b->key < a->key) {
+            result.push_back(*b);
+            ++b;
+        } else {
+            result.push_back(uniteContainers(*a, *b));
+            ++a;
+            ++b;
+        }
+    }
+
+    m_containers.swap(result);
+    return *this;
+}
+
+Bitmap& Bitmap::subtract(const Bitmap& other)
+{
+    std::vector<Container> result;
+
+    auto b = other.m_containers.begin();
+
+    for (auto& a : m_containers) {
+        while (b != other.m_containers.end() && b->key < a.key) {
+            ++b;
+        }
+        if (b == other.m_containers.end() || b->key != a.key) {
+            result.push_back(std::move(a));
+            continue;
+        }
+        auto c = subtractContainers(a, *b);
+        if (c.cardinality) {
+            result.push_back(std::move(c));
+        }
+    }
+
+    m_containers.swap(result);
+    return *this;
+}
+
+Bitmap Bitmap::range(quint32 from, quint32 to) const
+{
+    Bitmap ret;
+
+    if (from > to) {
+        return ret;
+    }
+
+    const auto fromKey = quint16(from >> 16);
+    const auto toKey = quint16(to >> 16);
+
+    for (auto it = findContainer(fromKey);
+         it != m_containers.end() && it->key <= toKey; ++it) {
+        const quint32 high = quint32(it->key) << 16;
+
+        if (high >= from && (high | 0xffff) <= to) {
+            ret.m_containers.push_back(*it);
+            continue;
+        }
+
+        Container c;
+        c.key = it->key;
+
+        Bitmap part;
+        part.m_containers.push_back(*it);
+        part.forEach([&](quint32 value) {
+            if (value >= from && value <= to) {
+                c.array.push_back(quint16(value & 0xffff));
+            }
+        });
+
+        c.cardinality = int(c.array.size());
+        if (c.cardinality) {
+            c.normalize();
+            ret.m_containers.push_back(std::move(c));
+        }
+    }
+
+    return ret;
+}
+
+QVector<quint32> Bitmap::values() const
+{
+    QVector<quint32> ret;
+    ret.reserve(int(count()));
+
+    forEach([&](quint32 value) { ret.append(value); });
+
+    return ret;
+}
+
+bool Bitmap::operator==(const Bitmap& other) const
+{
+    return m_containers == other.m_containers;
+}
+
+bool Bitmap::operator!=(const Bitmap& other) const
+{
+    return !(*this == other);
+}
+
+} // namespace tagberry::models
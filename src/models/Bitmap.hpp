@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QVector>
+#include <QtGlobal>
+
+#include <bitset>
+#include <vector>
+
+namespace tagberry::models {
+
+// Compressed set of 32-bit integers, split into chunks by upper 16 bits.
+// Each chunk is a sorted array while sparse and a plain bitset when dense,
+// like in Roaring bitmaps.
+class Bitmap {
+public:
+    bool isEmpty() const;
+    quint64 count() const;
+
+    bool contains(quint32 value) const;
+
+    void add(quint32 value);
+    void remove(quint32 value);
+    void clear();
+
+    Bitmap& intersect(const Bitmap& other);
+    Bitmap& unite(const Bitmap& other);
+    Bitmap& subtract(const Bitmap& other);
+
+    // values in [from; to]
+    Bitmap range(quint32 from, quint32 to) const;
+
+    QVector<quint32> values() const;
+
+    template <class Fn> void forEach(Fn fn) const;
+
+    bool operator==(const Bitmap& other) const;
+    bool operator!=(const Bitmap& other) const;
+
+private:
+    enum { MaxArraySize = 4096, BitsetWords = 1024 };
+
+    struct Container {
+        quint16 key {};
+        int cardinality {};
+        std::vector<quint16> array;
+        std::vector<quint64> bits;
+
+        bool isBitset() const;
+        bool contains(quint16 low) const;
+
+        void toBitset();
+        void toArray();
+        void normalize();
+
+        bool operator==(const Container& other) const;
+    };
+
+    std::vector<Container>::iterator findContainer(quint16 key);
+    std::vector<Container>::const_iterator findContainer(quint16 key) const;
+
+    static Container intersectContainers(const Container& a, const Container& b);
+    static Container uniteContainers(const Container& a, const Container& b);
+    static Container subtractContainers(const Container& a, const Container& b);
+
+    std::vector<Container> m_containers;
+};
+
+template <class Fn> void Bitmap::forEach(Fn fn) const
+{
+    for (const auto& c : m_containers) {
+        const quint32 high = quint32(c.key) << 16;
+
+        if (!c.isBitset()) {
+            for (auto low : c.array) {
+                fn(high | low);
+            }
+            continue;
+        }
+
+        for (int n = 0; n < BitsetWords; n++) {
+            auto word = c.bits[size_t(n)];
+            while (word) {
+                const auto lowest = word & (~word + 1);
+                const auto bit = quint32(std::bitset<64>(lowest - 1).count());
+                fn(high | (quint32(n) << 6) | bit);
+                word ^= lowest;
+            }
+        }
+    }
+}
+
+} // namespace tagberry::models
@@ -10,6 +10,8 @@
 #include "models/ColorScheme.hpp"
 
 #include <QCryptographicHash>
+#include <QFont>
+#include <QFontDatabase>
 
 #include <algorithm>
 #include <functional>
@@ -42,17 +44,49 @@ QColor fadeColor(const QColor c, float fade)
     return QColor(r, g, b);
 }
 
-int tagIndex(const QString& name, int size)
+// FNV-1a over UTF-16 code units; deterministic across runs and platforms
+quint32 nameHash(const QString& name)
 {
-    auto str
-        = QCryptographicHash::hash(name.toUtf8(), QCryptographicHash::Md5).toStdString();
-
-    const size_t hash = std::hash<std::string>()(str);
-    const int index = int(hash % size_t(size));
-
-    return index;
+    quint32 hash = 2166136261u;
+    const ushort* data = name.utf16();
+    for (int n = 0; n < name.size(); n++) {
+        hash ^= data[n];
+        hash *= 16777619u;
+    }
+    return hash;
 }
 
+// names used by makeTextFormats(), per highlighter state
+const QPair<const char*, MarkdownHighlighter::HighlighterState> formatStates[] = {
+    { "empty", MarkdownHighlighter::NoState },
+    { "headline-end", MarkdownHighlighter::HeadlineEnd },
+    { "h1", MarkdownHighlighter::H1 },
+    { "h2", MarkdownHighlighter::H2 },
+    { "h3", MarkdownHighlighter::H3 },
+    { "h4", MarkdownHighlighter::H4 },
+    { "h5", MarkdownHighlighter::H5 },
+    { "h6", MarkdownHighlighter::H6 },
+    { "horizontal-ruler", MarkdownHighlighter::HorizontalRuler },
+    { "list", MarkdownHighlighter::List },
+    { "link", MarkdownHighlighter::Link },
+    { "image", MarkdownHighlighter::Image },
+    { "italic", MarkdownHighlighter::Italic },
+    { "bold", MarkdownHighlighter::Bold },
+    { "comment", MarkdownHighlighter::Comment },
+    { "masked-syntax", MarkdownHighlighter::MaskedSyntax },
+    { "table", MarkdownHighlighter::Table },
+    { "block-quote", MarkdownHighlighter::BlockQuote },
+    { "code-block", MarkdownHighlighter::CodeBlock },
+    { "inline-code-block", MarkdownHighlighter::InlineCodeBlock },
+    { "code-keyword", MarkdownHighlighter::CodeKeyWord },
+    { "code-type", MarkdownHighlighter::CodeType },
+    { "code-builtin", MarkdownHighlighter::CodeBuiltIn },
+    { "code-string", MarkdownHighlighter::CodeString },
+    { "code-number", MarkdownHighlighter::CodeNumLiteral },
+    { "code-comment", MarkdownHighlighter::CodeComment },
+    { "code-other", MarkdownHighlighter::CodeOther },
+};
+
 } // namespace
 
 ColorScheme::ColorScheme()
@@ -95,6 +129,8 @@ ColorScheme::ColorScheme()
         "#479493",
         "#8f9140",
     };
+
+    rebuildTagColors();
 }
 
 QHash<QString, QColor> ColorScheme::widgetColors() const
@@ -102,45 +138,178 @@ QHash<QString, QColor> ColorScheme::widgetColors() const
     return m_widgetColors;
 }
 
-QHash<QString, QColor> ColorScheme::tagColors(const QString& name) const
+int ColorScheme::tagIndex(const QString& name) const
 {
-    auto colors = m_tagsCache.object(name);
-    if (colors) {
-        return *colors;
+    if (m_tagColors.isEmpty()) {
+        return -1;
     }
 
-    colors = builtinTagColors(name);
-    if (colors) {
-        m_tagsCache.insert(name, colors);
-        return *colors;
+    return int(nameHash(name) % quint32(m_tagColors.size()));
+}
+
+int ColorScheme::legacyTagIndex(const QString& name) const
+{
+    if (m_tagColors.isEmpty()) {
+        return -1;
+    }
+
+    auto str
+        = QCryptographicHash::hash(name.toUtf8(), QCryptographicHash::Md5).toStdString();
+
+    const size_t hash = std::hash<std::string>()(str);
+
+    return int(hash % size_t(m_tagColors.size()));
+}
+
+QHash<QString, QColor> ColorScheme::tagColors(int index) const
+{
+    if (index < 0 || m_tagColors.isEmpty()) {
+        return {};
     }
 
-    return {};
+    return m_tagColors[index % m_tagColors.size()];
 }
 
-QHash<QString, QColor>* ColorScheme::builtinTagColors(const QString& name) const
+TextFormats ColorScheme::textFormats(int fontSize) const
 {
-    if (!m_builtinTagColors.size()) {
-        return nullptr;
+    auto it = m_textFormats.constFind(fontSize);
+    if (it != m_textFormats.constEnd()) {
+        return it.value();
+    }
+
+    const auto named = makeTextFormats(fontSize);
+
+    TextFormats formats;
+    for (const auto& entry : formatStates) {
+        formats[entry.second] = named.value(entry.first);
     }
 
-    int index = tagIndex(name, m_builtinTagColors.size());
+    return *m_textFormats.insert(fontSize, formats);
+}
 
-    auto color = m_builtinTagColors[index];
+void ColorScheme::rebuildTagColors()
+{
+    m_tagColors.clear();
+    m_tagColors.reserve(m_builtinTagColors.size());
 
-    return makeTagColors(color);
+    for (auto color : m_builtinTagColors) {
+        m_tagColors.append(makeTagColors(color));
+    }
 }
 
-QHash<QString, QColor>* ColorScheme::makeTagColors(QColor baseColor) const
+QHash<QString, QColor> ColorScheme::makeTagColors(QColor baseColor) const
 {
-    auto colors = new QHash<QString, QColor>;
+    QHash<QString, QColor> colors;
 
-    (*colors)["background"] = m_widgetColors["background"];
-    (*colors)["regular"] = baseColor;
-    (*colors)["focused-complete"] = lightenColor(baseColor, 50);
-    (*colors)["focused-incomplete"] = fadeColor(baseColor, 0.9f);
+    colors["background"] = m_widgetColors["background"];
+    colors["regular"] = baseColor;
+    colors["focused-complete"] = lightenColor(baseColor, 50);
+    colors["focused-incomplete"] = fadeColor(baseColor, 0.9f);
 
     return colors;
 }
 
+QHash<QString, QTextCharFormat> ColorScheme::makeTextFormats(int fontSize) const
+{
+    QHash<QString, QTextCharFormat> formats;
+
+    const auto color = [=](const char* name) {
+        return QBrush(m_widgetColors.value(name));
+    };
+
+    const auto codeFont = QFont("monospace", fontSize - 1);
+
+    formats["empty"] = QTextCharFormat();
+    formats["headline-end"] = QTextCharFormat();
+
+    {
+        QTextCharFormat format;
+        format.setFontWeight(QFont::Bold);
+        format.setForeground(color("text-light"));
+
+        const double scales[] = { 1.4, 1.3, 1.2, 1.1, 1.0, 1.0 };
+
+        for (int level = 1; level <= 6; level++) {
+            format.setFontPointSize(fontSize * scales[level - 1]);
+            formats[QString("h%1").arg(level)] = format;
+        }
+    }
+
+    {
+        QTextCharFormat format;
+        format.setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+        format.setFontWeight(QFont::Bold);
+        format.setForeground(color("text-extra-light"));
+
+        formats["horizontal-ruler"] = format;
+    }
+
+    {
+        QTextCharFormat format;
+        format.setFontWeight(QFont::Bold);
+        format.setForeground(color("text-extra-light"));
+
+        formats["list"] = format;
+        formats["block-quote"] = format;
+    }
+
+    {
+        QTextCharFormat format;
+        format.setFontUnderline(true);
+        format.setForeground(color("text-url"));
+
+        formats["link"] = format;
+    }
+
+    {
+        QTextCharFormat format;
+        format.setFontWeight(QFont::Bold);
+        format.setForeground(color("text-light"));
+
+        formats["image"] = format;
+        formats["bold"] = format;
+    }
+
+    {
+        QTextCharFormat format;
+        format.setFontWeight(QFont::StyleItalic);
+        format.setFontItalic(true);
+
+        formats["italic"] = format;
+    }
+
+    {
+        QTextCharFormat format;
+        format.setForeground(color("text-extra-light"));
+
+        formats["comment"] = format;
+        formats["masked-syntax"] = format;
+    }
+
+    {
+        QTextCharFormat format;
+        format.setFont(codeFont);
+        format.setForeground(color("text-light"));
+
+        formats["table"] = format;
+    }
+
+    {
+        QTextCharFormat format;
+        format.setFont(codeFont);
+        format.setBackground(color("code-background"));
+
+        formats["code-block"] = format;
+        formats["inline-code-block"] = format;
+
+        for (auto name : { "code-keyword", "code-type", "code-builtin", "code-string",
+                 "code-number", "code-comment", "code-other" }) {
+            format.setForeground(color(name));
+            formats[name] = format;
+        }
+    }
+
+    return formats;
+}
+
 } // namespace tagberry::models
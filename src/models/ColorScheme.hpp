@@ -9,15 +9,20 @@
 
 #pragma once
 
-#include <QCache>
 #include <QColor>
 #include <QHash>
 #include <QList>
 #include <QObject>
 #include <QString>
+#include <QTextCharFormat>
+#include <QVector>
+
+#include <markdownhighlighter.h>
 
 namespace tagberry::models {
 
+using TextFormats = QHash<MarkdownHighlighter::HighlighterState, QTextCharFormat>;
+
 class ColorScheme : public QObject {
     Q_OBJECT
 
@@ -25,19 +30,35 @@ public:
     ColorScheme();
 
     QHash<QString, QColor> widgetColors() const;
-    QHash<QString, QColor> tagColors(const QString& name) const;
+
+    // palette index for a tag name, -1 if palette is empty
+    int tagIndex(const QString& name) const;
+
+    // palette index assigned by releases prior to tags.color column,
+    // used only to pin colors of existing tags
+    int legacyTagIndex(const QString& name) const;
+
+    QHash<QString, QColor> tagColors(int index) const;
+
+    // formats of markdown highlighter states, built once per font size
+    // and shared until widget colors change
+    TextFormats textFormats(int fontSize) const;
 
 signals:
+    // emitter must drop m_textFormats first, they depend on widget colors
     void widgetColorsChanged(QHash<QString, QColor>);
     void tagColorsChanged();
 
 private:
-    QHash<QString, QColor>* builtinTagColors(const QString& name) const;
-    QHash<QString, QColor>* makeTagColors(QColor baseColor) const;
+    void rebuildTagColors();
+    QHash<QString, QColor> makeTagColors(QColor baseColor) const;
+    QHash<QString, QTextCharFormat> makeTextFormats(int fontSize) const;
 
     QHash<QString, QColor> m_widgetColors;
     QList<QColor> m_builtinTagColors;
-    mutable QCache<QString, QHash<QString, QColor>> m_tagsCache;
+    QVector<QHash<QString, QColor>> m_tagColors;
+
+    mutable QHash<int, TextFormats> m_textFormats;
 };
 
 } // namespace tagberry::models
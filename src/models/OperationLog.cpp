@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "models/OperationLog.hpp"
+
+namespace tagberry::models {
+
+static_assert(sizeof(Operation) <= 32, "operations are kept by thousands");
+
+namespace {
+
+qint32 toDay(const QDate& date)
+{
+    return date.isValid() ? qint32(date.toJulianDay()) : 0;
+}
+
+} // namespace
+
+RecordState::RecordState(const Record& record)
+    : id(record.id())
+    , date(record.date())
+    , complete(record.complete())
+    , title(record.title())
+    , description(record.description())
+{
+    for (const auto& tag : record.tags()) {
+        if (tag->id()) {
+            tagIDs.append(tag->id());
+        }
+    }
+}
+
+OperationLog::OperationLog(int capacity)
+    : m_ops(size_t(capacity))
+{
+}
+
+void OperationLog::beginGroup()
+{
+    m_depth++;
+}
+
+void OperationLog::endGroup()
+{
+    if (--m_depth > 0) {
+        return;
+    }
+
+    m_depth = 0;
+    m_groupSize = 0;
+    m_overflow = false;
+}
+
+void OperationLog::addChange(const RecordState& before, const RecordState& after)
+{
+    if (!after.id) {
+        return;
+    }
+
+    beginGroup();
+
+    // created record is undone by clearing its fields and removing it
+    const RecordState empty;
+    const auto& old = before.id ? before : empty;
+
+    if (!before.id) {
+        Operation op;
+        op.kind = Operation::Kind::RemoveRecord;
+        op.recordID = after.id;
+        push(op);
+    }
+
+    if (old.title != after.title) {
+        addField(after.id, Operation::Kind::Title, old);
+    }
+    if (old.description != after.description) {
+        addField(after.id, Operation::Kind::Description, old);
+    }
+    if (old.complete != after.complete) {
+        addField(after.id, Operation::Kind::Complete, old);
+    }
+    if (old.date != after.date) {
+        addField(after.id, Operation::Kind::Date, old);
+    }
+    if (old.tagIDs != after.tagIDs) {
+        addField(after.id, Operation::Kind::Tags, old);
+    }
+
+    endGroup();
+}
+
+// fields go first, so that undo restores record before filling it
+void OperationLog::addRemove(const RecordState& before)
+{
+    if (!before.id) {
+        return;
+    }
+
+    beginGroup();
+
+    const RecordState empty;
+
+    if (before.title != empty.title) {
+        addField(before.id, Operation::Kind::Title, before);
+    }
+    if (before.description != empty.description) {
+        addField(before.id, Operation::Kind::Description, before);
+    }
+    if (before.complete != empty.complete) {
+        addField(before.id, Operation::Kind::Complete, before);
+    }
+    if (before.date != empty.date) {
+        addField(before.id, Operation::Kind::Date, before);
+    }
+    if (before.tagIDs != empty.tagIDs) {
+        addField(before.id, Operation::Kind::Tags, before);
+    }
+
+    Operation op;
+    op.kind = Operation::Kind::RestoreRecord;
+    op.recordID = before.id;
+    push(op);
+
+    endGroup();
+}
+
+bool OperationLog::canUndo() const
+{
+    return m_pos > 0;
+}
+
+bool OperationLog::canRedo() const
+{
+    return m_pos < m_size;
+}
+
+std::vector<Operation*> OperationLog::undoGroup()
+{
+    std::vector<Operation*> ret;
+
+    while (m_pos > 0) {
+        auto& op = at(--m_pos);
+        ret.push_back(&op);
+        if (op.groupStart) {
+            break;
+        }
+    }
+
+    return ret;
+}
+
+std::vector<Operation*> OperationLog::redoGroup()
+{
+    std::vector<Operation*> ret;
+
+    while (m_pos < m_size) {
+        ret.push_back(&at(m_pos++));
+        if (m_pos == m_size || at(m_pos).groupStart) {
+            break;
+        }
+    }
+
+    return ret;
+}
+
+void OperationLog::remapRecord(quint32 oldID, quint32 newID)
+{
+    for (int n = 0; n < m_size; n++) {
+        auto& op = at(n);
+        if (op.recordID == oldID) {
+            op.recordID = newID;
+        }
+    }
+}
+
+void OperationLog::clear()
+{
+    for (int n = 0; n < m_size; n++) {
+        at(n) = Operation();
+    }
+
+    m_begin = 0;
+    m_size = 0;
+    m_pos = 0;
+}
+
+void OperationLog::addField(
+    quint32 recordID, Operation::Kind kind, const RecordState& state)
+{
+    Operation op;
+    op.kind = kind;
+    op.recordID = recordID;
+
+    switch (kind) {
+    case Operation::Kind::Title:
+        op.text = state.title;
+        break;
+    case Operation::Kind::Description:
+        op.text = state.description;
+        break;
+    case Operation::Kind::Complete:
+        op.value = state.complete ? 1 : 0;
+        break;
+    case Operation::Kind::Date:
+        op.value = toDay(state.date);
+        break;
+    case Operation::Kind::Tags:
+        op.tagIDs = state.tagIDs;
+        break;
+    case Operation::Kind::RemoveRecord:
+    case Operation::Kind::RestoreRecord:
+        break;
+    }
+
+    push(std::move(op));
+}
+
+void OperationLog::push(Operation op)
+{
+    if (m_overflow || m_ops.empty()) {
+        return;
+    }
+
+    // new change makes undone operations unreachable
+    while (m_size > m_pos) {
+        at(--m_size) = Operation();
+    }
+
+    const int capacity = int(m_ops.size());
+
+    if (m_size == capacity) {
+        // whole ring is taken by current group, it can't be undone
+        if (m_groupSize == m_size) {
+            clear();
+            m_overflow = true;
+            return;
+        }
+
+        do {
+            at(0) = Operation();
+            m_begin = (m_begin + 1) % capacity;
+            m_size--;
+            m_pos--;
+        } while (m_size > 0 && !at(0).groupStart);
+    }
+
+    op.groupStart = m_depth == 0 || m_groupSize == 0;
+
+    if (m_depth > 0) {
+        m_groupSize++;
+    }
+
+    at(m_size++) = std::move(op);
+    m_pos = m_size;
+}
+
+Operation& OperationLog::at(int n)
+{
+    return m_ops[size_t((m_begin + n) % int(m_ops.size()))];
+}
+
+} // namespace tagberry::models
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "models/Record.hpp"
+
+#include <QDate>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+#include <vector>
+
+namespace tagberry::models {
+
+// Saved state of record, compared before and after change to log it.
+struct RecordState {
+    RecordState() = default;
+    explicit RecordState(const Record& record);
+
+    quint32 id {};
+    QDate date;
+    bool complete {};
+    QString title;
+    QString description;
+    QVector<quint32> tagIDs;
+};
+
+// Reversible change of one record. Applying operation swaps its value
+// with record's one, so the same operation undoes and then redoes change.
+// Strings are shared with models, so operation itself takes 32 bytes.
+struct Operation {
+    enum class Kind : quint8 {
+        Title,
+        Description,
+        Complete,
+        Date,
+        Tags,
+        // applied by removing record, turns into RestoreRecord
+        RemoveRecord,
+        // applied by creating empty record, turns into RemoveRecord
+        RestoreRecord,
+    };
+
+    QString text;
+    QVector<quint32> tagIDs;
+    quint32 recordID {};
+    // complete flag, or julian day with zero for no date
+    qint32 value {};
+    Kind kind {};
+    // operations are undone by groups, e.g. batch of script requests
+    bool groupStart {};
+};
+
+// Bounded ring of operations, with position between done and undone ones.
+// Oldest groups are dropped when ring is full.
+class OperationLog {
+public:
+    explicit OperationLog(int capacity = DefaultCapacity);
+
+    // changes logged until matching endGroup() are undone together
+    void beginGroup();
+    void endGroup();
+
+    // to be called after change was saved; create if before has no id
+    void addChange(const RecordState& before, const RecordState& after);
+    void addRemove(const RecordState& before);
+
+    bool canUndo() const;
+    bool canRedo() const;
+
+    // operations of next group, in order they must be applied;
+    // position moves over group
+    std::vector<Operation*> undoGroup();
+    std::vector<Operation*> redoGroup();
+
+    // record got new id when it was restored
+    void remapRecord(quint32 oldID, quint32 newID);
+
+    void clear();
+
+private:
+    enum { DefaultCapacity = 8192 };
+
+    void addField(quint32 recordID, Operation::Kind kind, const RecordState& state);
+    void push(Operation op);
+    Operation& at(int n);
+
+    std::vector<Operation> m_ops;
+    int m_begin {};
+    int m_size {};
+    // operations before it are done, after it are undone
+    int m_pos {};
+
+    int m_depth {};
+    int m_groupSize {};
+    // group outgrew ring, its rest is not logged
+    bool m_overflow {};
+};
+
+} // namespace tagberry::models
@@ -31,17 +31,17 @@ void Record::unsetDirty()
     m_isDirty = false;
 }
 
-QString Record::id() const
+quint32 Record::id() const
 {
     return m_id;
 }
 
 bool Record::hasID() const
 {
-    return !m_id.isEmpty();
+    return m_id != 0;
 }
 
-void Record::setID(QString id)
+void Record::setID(quint32 id)
 {
     if (m_id == id) {
         return;
@@ -103,26 +103,30 @@ QList<TagPtr> Record::tags() const
 
 bool Record::hasTag(TagPtr tag) const
 {
-    return m_tags.indexOf(tag) != -1;
+    return std::binary_search(m_tagHandles.begin(), m_tagHandles.end(), tag->handle());
 }
 
 void Record::addTag(TagPtr tag)
 {
-    if (m_tags.indexOf(tag) != -1) {
+    if (hasTag(tag)) {
         return;
     }
     m_isDirty = true;
     m_tags.append(tag);
+    m_tagHandles.insert(
+        std::lower_bound(m_tagHandles.begin(), m_tagHandles.end(), tag->handle()),
+        tag->handle());
     tagsChanged();
 }
 
 void Record::removeTag(TagPtr tag)
 {
-    if (m_tags.indexOf(tag) == -1) {
+    if (!hasTag(tag)) {
         return;
     }
     m_isDirty = true;
     m_tags.removeAll(tag);
+    updateTagHandles();
     tagsChanged();
 }
 
@@ -134,9 +138,19 @@ void Record::setTags(QList<TagPtr> tags)
     }
     m_isDirty = true;
     m_tags = tags;
+    updateTagHandles();
     tagsChanged();
 }
 
+void Record::updateTagHandles()
+{
+    m_tagHandles.clear();
+    for (const auto& tag : m_tags) {
+        m_tagHandles.append(tag->handle());
+    }
+    std::sort(m_tagHandles.begin(), m_tagHandles.end());
+}
+
 QString Record::description() const
 {
     return m_description;
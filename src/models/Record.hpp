@@ -15,6 +15,7 @@
 #include <QList>
 #include <QObject>
 #include <QString>
+#include <QVarLengthArray>
 
 #include <memory>
 
@@ -27,17 +28,20 @@ public:
     bool isDirty() const;
     void unsetDirty();
 
-    QString id() const;
+    // sqlite rowid, zero if record is not saved yet
+    quint32 id() const;
     bool hasID() const;
-    void setID(QString);
+    void setID(quint32);
 
     QDate date() const;
     bool complete() const;
     QString title() const;
     QString description() const;
 
+    // in order of adding
     QList<TagPtr> tags() const;
 
+    // binary search over sorted tag handles
     bool hasTag(TagPtr) const;
     void addTag(TagPtr);
     void removeTag(TagPtr);
@@ -50,7 +54,7 @@ public slots:
     void setDescription(QString);
 
 signals:
-    void idChanged(QString);
+    void idChanged(quint32);
     void dateChanged(QDate oldDate, QDate newDate);
     void completeChanged(bool);
     void titleChanged(QString);
@@ -58,12 +62,15 @@ signals:
     void descriptionChanged(QString);
 
 private:
+    void updateTagHandles();
+
     bool m_isDirty { true };
-    QString m_id;
+    quint32 m_id {};
     QDate m_date;
     bool m_complete {};
     QString m_title;
     QList<TagPtr> m_tags;
+    QVarLengthArray<quint32, 8> m_tagHandles;
     QString m_description;
 };
 
@@ -8,48 +8,63 @@
  */
 
 #include "models/RecordSet.hpp"
+#include "models/RecordsDirectory.hpp"
+
+#include <algorithm>
 
 namespace tagberry::models {
 
+RecordSet::RecordSet(RecordsDirectory& recDir)
+    : m_recDir(recDir)
+    , m_rows(recDir.resource())
+{
+}
+
 QList<RecordPtr> RecordSet::getRecords() const
 {
-    return m_records;
+    QList<RecordPtr> records;
+    for (auto row : m_rows) {
+        records.append(m_recDir.getRecord(row));
+    }
+    return records;
 }
 
-void RecordSet::addRecord(RecordPtr rec)
+const std::pmr::vector<int>& RecordSet::getRows() const
 {
-    if (m_records.indexOf(rec) != -1) {
+    return m_rows;
+}
+
+void RecordSet::addRow(int row)
+{
+    if (std::find(m_rows.begin(), m_rows.end(), row) != m_rows.end()) {
         return;
     }
 
-    connect(rec.get(), &Record::tagsChanged, this, &RecordSet::recordTagsChanged);
-    connect(rec.get(), &Record::completeChanged, this, &RecordSet::recordStatesChanged);
-
-    m_records.append(rec);
+    m_rows.push_back(row);
 
     notifyChanged();
 }
 
-void RecordSet::removeRecord(RecordPtr rec)
+void RecordSet::removeRow(int row)
 {
-    if (m_records.indexOf(rec) == -1) {
+    auto it = std::find(m_rows.begin(), m_rows.end(), row);
+    if (it == m_rows.end()) {
         return;
     }
 
-    disconnect(rec.get(), nullptr, this, nullptr);
-
-    m_records.removeAll(rec);
+    m_rows.erase(it);
 
     notifyChanged();
 }
 
-void RecordSet::clearRecords()
+void RecordSet::releaseRows()
 {
-    for (auto rec : m_records) {
-        disconnect(rec.get(), nullptr, this, nullptr);
-    }
+    std::pmr::vector<int>(m_rows.get_allocator()).swap(m_rows);
+}
 
-    m_records.clear();
+void RecordSet::clearRecords()
+{
+    m_rows.clear();
 
     notifyChanged();
 }
@@ -63,22 +78,33 @@ void RecordSet::notifyChanged()
 
 QList<TagPtr> RecordSet::getAllTags() const
 {
-    QList<TagPtr> tags;
-    for (auto rec : m_records) {
-        for (auto tag : rec->tags()) {
-            if (tags.indexOf(tag) == -1) {
-                tags.append(tag);
+    const auto& store = m_recDir.store();
+
+    std::vector<quint32> handles;
+    for (auto row : m_rows) {
+        for (int n = 0; n < store.tagCount(row); n++) {
+            auto handle = store.tagAt(row, n);
+            if (std::find(handles.begin(), handles.end(), handle) == handles.end()) {
+                handles.push_back(handle);
             }
         }
     }
+
+    QList<TagPtr> tags;
+    for (auto handle : handles) {
+        tags.append(m_recDir.tagByHandle(handle));
+    }
     return tags;
 }
 
 int RecordSet::numRecordsWithTag(TagPtr tag)
 {
+    const auto& store = m_recDir.store();
+    const auto handle = tag->handle();
+
     int ret = 0;
-    for (auto rec : m_records) {
-        if (rec->hasTag(tag)) {
+    for (auto row : m_rows) {
+        if (store.hasTag(row, handle)) {
             ret++;
         }
     }
@@ -87,11 +113,14 @@ int RecordSet::numRecordsWithTag(TagPtr tag)
 
 bool RecordSet::checkAllRecordsWithTagComplete(TagPtr tag)
 {
-    for (auto rec : m_records) {
-        if (!rec->hasTag(tag)) {
+    const auto& store = m_recDir.store();
+    const auto handle = tag->handle();
+
+    for (auto row : m_rows) {
+        if (!store.hasTag(row, handle)) {
             continue;
         }
-        if (!rec->complete()) {
+        if (!store.complete(row)) {
             return false;
         }
     }
@@ -16,17 +16,30 @@
 #include <QString>
 
 #include <memory>
+#include <memory_resource>
+#include <vector>
 
 namespace tagberry::models {
 
+class RecordsDirectory;
+
+// Records of one day, as rows of the directory store. Counting tags
+// doesn't need Record objects, they're created only by getRecords().
 class RecordSet : public QObject, public std::enable_shared_from_this<RecordSet> {
     Q_OBJECT
 
 public:
+    explicit RecordSet(RecordsDirectory& recDir);
+
     QList<RecordPtr> getRecords() const;
 
-    void addRecord(RecordPtr);
-    void removeRecord(RecordPtr);
+    const std::pmr::vector<int>& getRows() const;
+
+    void addRow(int row);
+    void removeRow(int row);
+
+    // drops rows without notifying, before directory releases its arena
+    void releaseRows();
 
     void clearRecords();
 
@@ -44,7 +57,8 @@ signals:
 private:
     void notifyChanged();
 
-    QList<RecordPtr> m_records;
+    RecordsDirectory& m_recDir;
+    std::pmr::vector<int> m_rows;
 };
 
 using RecordSetPtr = std::shared_ptr<RecordSet>;
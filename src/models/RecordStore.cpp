@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "models/RecordStore.hpp"
+
+#include <algorithm>
+
+namespace tagberry::models {
+
+namespace {
+
+// julian day 0 is far before any real record
+const qint32 noDay = 0;
+
+qint32 toDay(const QDate& date)
+{
+    return date.isValid() ? qint32(date.toJulianDay()) : noDay;
+}
+
+// unlike clear(), frees buffer too
+template <class Container> void reset(Container& container)
+{
+    Container(container.get_allocator()).swap(container);
+}
+
+} // namespace
+
+size_t RecordStore::StringHash::operator()(const QString& str) const
+{
+    return qHash(str);
+}
+
+RecordStore::RecordStore(std::pmr::memory_resource* resource)
+    : m_ids(resource)
+    , m_days(resource)
+    , m_flags(resource)
+    , m_titles(resource)
+    , m_descriptions(resource)
+    , m_tagOffsets(resource)
+    , m_tagCounts(resource)
+    , m_tagHandles(resource)
+    , m_strings(resource)
+    , m_stringHandles(resource)
+    , m_rowByID(resource)
+{
+}
+
+void RecordStore::clear()
+{
+    reset(m_ids);
+    reset(m_days);
+    reset(m_flags);
+    reset(m_titles);
+    reset(m_descriptions);
+
+    reset(m_tagOffsets);
+    reset(m_tagCounts);
+    reset(m_tagHandles);
+
+    reset(m_strings);
+    reset(m_stringHandles);
+
+    reset(m_rowByID);
+}
+
+int RecordStore::rowCount() const
+{
+    return int(m_ids.size());
+}
+
+int RecordStore::addRow(quint32 id, const QDate& date, bool complete,
+    const QString& title, const QString& description)
+{
+    const int row = rowCount();
+
+    m_ids.push_back(id);
+    m_days.push_back(toDay(date));
+    m_flags.push_back(quint8(complete ? Complete : 0));
+    m_titles.push_back(intern(title));
+    m_descriptions.push_back(intern(description));
+
+    m_tagOffsets.push_back(quint32(m_tagHandles.size()));
+    m_tagCounts.push_back(0);
+
+    if (id) {
+        m_rowByID[id] = row;
+    }
+
+    return row;
+}
+
+void RecordStore::removeRow(int row)
+{
+    auto& flags = m_flags[size_t(row)];
+
+    if (flags & Removed) {
+        return;
+    }
+
+    flags |= Removed;
+
+    if (auto id = m_ids[size_t(row)]) {
+        m_rowByID.erase(id);
+    }
+}
+
+int RecordStore::rowByID(quint32 id) const
+{
+    auto it = m_rowByID.find(id);
+    return it != m_rowByID.end() ? it->second : -1;
+}
+
+bool RecordStore::isRemoved(int row) const
+{
+    return m_flags[size_t(row)] & Removed;
+}
+
+quint32 RecordStore::id(int row) const
+{
+    return m_ids[size_t(row)];
+}
+
+void RecordStore::setID(int row, quint32 id)
+{
+    auto& oldID = m_ids[size_t(row)];
+
+    if (oldID == id) {
+        return;
+    }
+
+    if (oldID) {
+        m_rowByID.erase(oldID);
+    }
+    if (id) {
+        m_rowByID[id] = row;
+    }
+
+    oldID = id;
+}
+
+QDate RecordStore::date(int row) const
+{
+    const auto day = m_days[size_t(row)];
+    return day == noDay ? QDate() : QDate::fromJulianDay(day);
+}
+
+void RecordStore::setDate(int row, const QDate& date)
+{
+    m_days[size_t(row)] = toDay(date);
+}
+
+bool RecordStore::complete(int row) const
+{
+    return m_flags[size_t(row)] & Complete;
+}
+
+void RecordStore::setComplete(int row, bool complete)
+{
+    auto& flags = m_flags[size_t(row)];
+
+    if (complete) {
+        flags |= Complete;
+    } else {
+        flags &= quint8(~Complete);
+    }
+}
+
+QString RecordStore::title(int row) const
+{
+    return m_strings[m_titles[size_t(row)]];
+}
+
+void RecordStore::setTitle(int row, const QString& title)
+{
+    m_titles[size_t(row)] = intern(title);
+}
+
+QString RecordStore::description(int row) const
+{
+    return m_strings[m_descriptions[size_t(row)]];
+}
+
+void RecordStore::setDescription(int row, const QString& description)
+{
+    m_descriptions[size_t(row)] = intern(description);
+}
+
+int RecordStore::tagCount(int row) const
+{
+    return m_tagCounts[size_t(row)];
+}
+
+quint32 RecordStore::tagAt(int row, int index) const
+{
+    return m_tagHandles[m_tagOffsets[size_t(row)] + size_t(index)];
+}
+
+bool RecordStore::hasTag(int row, quint32 handle) const
+{
+    auto begin = m_tagHandles.begin() + m_tagOffsets[size_t(row)];
+    auto end = begin + m_tagCounts[size_t(row)];
+
+    return std::binary_search(begin, end, handle);
+}
+
+void RecordStore::setTags(int row, std::vector<quint32> handles)
+{
+    std::sort(handles.begin(), handles.end());
+
+    auto& offset = m_tagOffsets[size_t(row)];
+    auto& count = m_tagCounts[size_t(row)];
+
+    // span is rewritten in place if it fits or is the last one,
+    // which is always the case while page is being loaded
+    const bool isLast = offset + count == m_tagHandles.size();
+
+    if (handles.size() > count && !isLast) {
+        offset = quint32(m_tagHandles.size());
+    }
+
+    m_tagHandles.resize(std::max(m_tagHandles.size(), offset + handles.size()));
+    std::copy(handles.begin(), handles.end(), m_tagHandles.begin() + offset);
+
+    count = quint16(handles.size());
+}
+
+quint32 RecordStore::intern(const QString& str)
+{
+    auto it = m_stringHandles.find(str);
+    if (it != m_stringHandles.end()) {
+        return it->second;
+    }
+
+    const auto handle = quint32(m_strings.size());
+
+    m_strings.push_back(str);
+    m_stringHandles.emplace(str, handle);
+
+    return handle;
+}
+
+} // namespace tagberry::models
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QDate>
+#include <QHash>
+#include <QString>
+#include <QtGlobal>
+
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+namespace tagberry::models {
+
+// Records of a page as parallel arrays, one row per record. Titles and
+// descriptions are interned strings, tags are sorted spans of handles in
+// one shared array. Rows are never moved, removed rows are only marked, and
+// replaced strings and spans stay allocated until clear().
+//
+// All containers allocate from given resource, usually a page arena.
+class RecordStore {
+public:
+    explicit RecordStore(
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // drops all rows and gives all memory back to resource
+    void clear();
+
+    // rows ever added, including removed ones
+    int rowCount() const;
+
+    // id is zero for records not saved yet
+    int addRow(quint32 id, const QDate& date, bool complete, const QString& title,
+        const QString& description);
+    void removeRow(int row);
+
+    // -1 if there is no such record
+    int rowByID(quint32 id) const;
+
+    bool isRemoved(int row) const;
+
+    quint32 id(int row) const;
+    void setID(int row, quint32 id);
+
+    QDate date(int row) const;
+    void setDate(int row, const QDate& date);
+
+    bool complete(int row) const;
+    void setComplete(int row, bool complete);
+
+    QString title(int row) const;
+    void setTitle(int row, const QString& title);
+
+    QString description(int row) const;
+    void setDescription(int row, const QString& description);
+
+    int tagCount(int row) const;
+    quint32 tagAt(int row, int index) const;
+    bool hasTag(int row, quint32 handle) const;
+    void setTags(int row, std::vector<quint32> handles);
+
+private:
+    enum Flag : quint8 { Complete = 1, Removed = 2 };
+
+    struct StringHash {
+        size_t operator()(const QString& str) const;
+    };
+
+    quint32 intern(const QString& str);
+
+    std::pmr::vector<quint32> m_ids;
+    std::pmr::vector<qint32> m_days;
+    std::pmr::vector<quint8> m_flags;
+    std::pmr::vector<quint32> m_titles;
+    std::pmr::vector<quint32> m_descriptions;
+
+    std::pmr::vector<quint32> m_tagOffsets;
+    std::pmr::vector<quint16> m_tagCounts;
+    std::pmr::vector<quint32> m_tagHandles;
+
+    std::pmr::vector<QString> m_strings;
+    std::pmr::unordered_map<QString, quint32, StringHash> m_stringHandles;
+
+    std::pmr::unordered_map<quint32, int> m_rowByID;
+};
+
+} // namespace tagberry::models
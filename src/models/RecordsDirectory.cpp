@@ -9,14 +9,41 @@
 
 #include "models/RecordsDirectory.hpp"
 
+#include <algorithm>
+
 namespace tagberry::models {
 
+namespace {
+
+// enough for a page of a typical calendar, bigger pages take more chunks
+const size_t arenaChunkSize = 64 * 1024;
+
+template <class Container> void reset(Container& container)
+{
+    Container(container.get_allocator()).swap(container);
+}
+
+} // namespace
+
+RecordsDirectory::RecordsDirectory()
+    : m_arena(arenaChunkSize)
+    , m_store(&m_arena)
+    , m_records(&m_arena)
+    , m_tags(&m_arena)
+{
+}
+
+std::pmr::memory_resource* RecordsDirectory::resource()
+{
+    return &m_arena;
+}
+
 RecordSetPtr RecordsDirectory::recordsByDate(const QDate& date)
 {
     auto recSet = m_recordsByDate[date];
 
     if (!recSet) {
-        recSet = std::make_shared<RecordSet>();
+        recSet = std::make_shared<RecordSet>(*this);
         m_recordsByDate[date] = recSet;
     }
 
@@ -26,92 +53,249 @@ RecordSetPtr RecordsDirectory::recordsByDate(const QDate& date)
 RecordSetPtr RecordsDirectory::recordsWithoutDate()
 {
     if (!m_recordWithoutDate) {
-        m_recordWithoutDate = std::make_shared<RecordSet>();
+        m_recordWithoutDate = std::make_shared<RecordSet>(*this);
     }
     return m_recordWithoutDate;
 }
 
 RecordPtr RecordsDirectory::createRecord()
 {
+    const int row = m_store.addRow(0, QDate(), false, QString(), QString());
+
     auto rec = std::make_shared<Record>();
 
-    connect(rec.get(), &Record::idChanged, this, &RecordsDirectory::recordIdChanged);
-    connect(rec.get(), &Record::dateChanged, this, &RecordsDirectory::recordDateChanged);
+    bindRecord(row, rec.get());
+    m_records.push_back(rec);
 
-    m_records.insert(rec);
-    recordsWithoutDate()->addRecord(rec);
+    recordsWithoutDate()->addRow(row);
 
     return rec;
 }
 
-RecordPtr RecordsDirectory::getOrCreateRecord(const QString& id)
+int RecordsDirectory::loadRecord(quint32 id, const QDate& date, bool complete,
+    const QString& title, const QString& description)
+{
+    int row = m_store.rowByID(id);
+
+    if (row < 0) {
+        row = m_store.addRow(id, date, complete, title, description);
+        m_records.emplace_back();
+
+        recordsOfDate(date)->addRow(row);
+
+        return row;
+    }
+
+    // bound record writes changes to store itself
+    if (auto rec = m_records[size_t(row)].lock()) {
+        rec->setDate(date);
+        rec->setComplete(complete);
+        rec->setTitle(title);
+        rec->setDescription(description);
+        rec->unsetDirty();
+
+        return row;
+    }
+
+    const auto oldDate = m_store.date(row);
+    const auto oldComplete = m_store.complete(row);
+
+    m_store.setDate(row, date);
+    m_store.setComplete(row, complete);
+    m_store.setTitle(row, title);
+    m_store.setDescription(row, description);
+
+    moveRow(row, oldDate, date);
+
+    if (oldComplete != complete) {
+        recordsOfDate(date)->recordStatesChanged();
+    }
+
+    return row;
+}
+
+void RecordsDirectory::loadRecordTags(int row, const QList<TagPtr>& tags)
+{
+    if (auto rec = m_records[size_t(row)].lock()) {
+        rec->setTags(tags);
+        rec->unsetDirty();
+
+        return;
+    }
+
+    const auto handles = pinTags(tags);
+
+    if (int(handles.size()) == m_store.tagCount(row)) {
+        bool same = true;
+        for (auto handle : handles) {
+            same = same && m_store.hasTag(row, handle);
+        }
+        if (same) {
+            return;
+        }
+    }
+
+    m_store.setTags(row, handles);
+
+    recordsOfDate(m_store.date(row))->recordTagsChanged();
+}
+
+RecordPtr RecordsDirectory::getRecord(int row)
 {
-    if (auto rec = m_recordByID[id]) {
+    if (auto rec = m_records[size_t(row)].lock()) {
         return rec;
     }
 
-    auto rec = createRecord();
-    rec->setID(id);
+    auto rec = std::make_shared<Record>();
+
+    rec->setID(m_store.id(row));
+
+    rec->setDate(m_store.date(row));
+    rec->setComplete(m_store.complete(row));
+    rec->setTitle(m_store.title(row));
+    rec->setDescription(m_store.description(row));
+
+    QList<TagPtr> tags;
+    for (int n = 0; n < m_store.tagCount(row); n++) {
+        tags.append(tagByHandle(m_store.tagAt(row, n)));
+    }
+    rec->setTags(tags);
+
+    rec->unsetDirty();
+
+    // bound after filling, so that it's not written back to store
+    bindRecord(row, rec.get());
+    m_records[size_t(row)] = rec;
 
     return rec;
 }
 
 void RecordsDirectory::removeRecord(RecordPtr rec)
 {
-    disconnect(rec.get(), nullptr, this, nullptr);
+    auto it = std::find_if(m_records.begin(), m_records.end(),
+        [&](const std::weak_ptr<Record>& r) { return r.lock() == rec; });
 
-    if (rec->date() == QDate()) {
-        recordsWithoutDate()->removeRecord(rec);
-    } else {
-        recordsByDate(rec->date())->removeRecord(rec);
+    if (it == m_records.end()) {
+        return;
     }
 
-    if (rec->hasID()) {
-        m_recordByID.remove(rec->id());
+    dropRow(int(it - m_records.begin()));
+}
+
+void RecordsDirectory::unloadRecord(quint32 id)
+{
+    const int row = m_store.rowByID(id);
+    if (row < 0) {
+        return;
     }
 
-    m_records.erase(rec);
+    dropRow(row);
 }
 
 void RecordsDirectory::clearRecords()
 {
-    for (auto rec : m_records) {
-        disconnect(rec.get(), nullptr, this, nullptr);
+    for (const auto& weakRec : m_records) {
+        if (auto rec = weakRec.lock()) {
+            disconnect(rec.get(), nullptr, this, nullptr);
+        }
+    }
+
+    // sets could outlive directory page, so their rows are dropped
+    for (const auto& recSet : m_recordsByDate) {
+        recSet->releaseRows();
+    }
+    if (m_recordWithoutDate) {
+        m_recordWithoutDate->releaseRows();
     }
 
-    m_recordByID.clear();
     m_recordsByDate.clear();
     m_recordWithoutDate.reset();
-    m_records.clear();
+
+    // nothing may point into arena after this
+    m_store.clear();
+    reset(m_records);
+    reset(m_tags);
+
+    m_arena.release();
 }
 
-void RecordsDirectory::recordIdChanged(QString id)
+const RecordStore& RecordsDirectory::store() const
 {
-    auto record = qobject_cast<Record*>(sender());
+    return m_store;
+}
 
-    for (auto it = m_recordByID.begin(); it != m_recordByID.end(); ++it) {
-        if (it.value().get() == record) {
-            m_recordByID.erase(it);
-            break;
-        }
+TagPtr RecordsDirectory::tagByHandle(quint32 handle) const
+{
+    auto it = m_tags.find(handle);
+    return it != m_tags.end() ? it->second : nullptr;
+}
+
+void RecordsDirectory::bindRecord(int row, Record* rec)
+{
+    connect(rec, &Record::idChanged, this, [=](quint32 id) { m_store.setID(row, id); });
+
+    connect(rec, &Record::dateChanged, this, [=](QDate oldDate, QDate newDate) {
+        m_store.setDate(row, newDate);
+        moveRow(row, oldDate, newDate);
+    });
+
+    connect(rec, &Record::completeChanged, this, [=](bool complete) {
+        m_store.setComplete(row, complete);
+        recordsOfDate(m_store.date(row))->recordStatesChanged();
+    });
+
+    connect(rec, &Record::titleChanged, this,
+        [=](QString title) { m_store.setTitle(row, title); });
+
+    connect(rec, &Record::descriptionChanged, this,
+        [=](QString description) { m_store.setDescription(row, description); });
+
+    connect(rec, &Record::tagsChanged, this, [=] {
+        m_store.setTags(row, pinTags(rec->tags()));
+        recordsOfDate(m_store.date(row))->recordTagsChanged();
+    });
+}
+
+RecordSetPtr RecordsDirectory::recordsOfDate(const QDate& date)
+{
+    return date.isValid() ? recordsByDate(date) : recordsWithoutDate();
+}
+
+void RecordsDirectory::moveRow(int row, const QDate& oldDate, const QDate& newDate)
+{
+    if (oldDate == newDate) {
+        return;
     }
 
-    if (!id.isEmpty()) {
-        m_recordByID[id] = record->shared_from_this();
+    recordsOfDate(oldDate)->removeRow(row);
+    recordsOfDate(newDate)->addRow(row);
+}
+
+void RecordsDirectory::dropRow(int row)
+{
+    auto& weakRec = m_records[size_t(row)];
+
+    if (auto rec = weakRec.lock()) {
+        disconnect(rec.get(), nullptr, this, nullptr);
     }
+    weakRec.reset();
+
+    recordsOfDate(m_store.date(row))->removeRow(row);
+    m_store.removeRow(row);
 }
 
-void RecordsDirectory::recordDateChanged(QDate oldDate, QDate newDate)
+// keeps page tags loaded while page is shown
+std::vector<quint32> RecordsDirectory::pinTags(const QList<TagPtr>& tags)
 {
-    auto rec = qobject_cast<Record*>(sender());
+    std::vector<quint32> handles;
+    handles.reserve(size_t(tags.size()));
 
-    if (oldDate == QDate()) {
-        recordsWithoutDate()->removeRecord(rec->shared_from_this());
-    } else {
-        recordsByDate(oldDate)->removeRecord(rec->shared_from_this());
+    for (const auto& tag : tags) {
+        m_tags.emplace(tag->handle(), tag);
+        handles.push_back(tag->handle());
     }
 
-    recordsByDate(newDate)->addRecord(rec->shared_from_this());
+    return handles;
 }
 
 } // namespace tagberry::models
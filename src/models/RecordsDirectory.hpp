@@ -11,38 +11,75 @@
 
 #include "models/Record.hpp"
 #include "models/RecordSet.hpp"
+#include "models/RecordStore.hpp"
 
 #include <QHash>
 #include <QList>
 #include <QObject>
 
-#include <unordered_set>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
 
 namespace tagberry::models {
 
+// Records of current page, kept compactly in RecordStore. Observable
+// Record objects are created on request, for records bound to editors,
+// and write their changes back to the store while alive.
+//
+// Store, record sets and indexes allocate from page arena, which is
+// released at once by clearRecords().
 class RecordsDirectory : public QObject {
     Q_OBJECT
 
 public:
+    RecordsDirectory();
+
+    std::pmr::memory_resource* resource();
+
     RecordSetPtr recordsByDate(const QDate&);
 
     RecordSetPtr recordsWithoutDate();
 
     RecordPtr createRecord();
 
-    RecordPtr getOrCreateRecord(const QString& id);
+    // adds record read from storage, or updates existing one with same id
+    int loadRecord(quint32 id, const QDate& date, bool complete, const QString& title,
+        const QString& description);
+    void loadRecordTags(int row, const QList<TagPtr>& tags);
+
+    // created on first request, shared while someone holds it
+    RecordPtr getRecord(int row);
 
     void removeRecord(RecordPtr);
 
+    // drops record removed or moved away by someone else, if loaded
+    void unloadRecord(quint32 id);
+
     void clearRecords();
 
-private slots:
-    void recordIdChanged(QString id);
-    void recordDateChanged(QDate oldDate, QDate newDate);
+    const RecordStore& store() const;
+
+    // tags of page records, referred by their handles in store
+    TagPtr tagByHandle(quint32 handle) const;
 
 private:
-    std::unordered_set<RecordPtr> m_records;
-    QHash<QString, RecordPtr> m_recordByID;
+    void bindRecord(int row, Record* rec);
+
+    RecordSetPtr recordsOfDate(const QDate& date);
+    void moveRow(int row, const QDate& oldDate, const QDate& newDate);
+    void dropRow(int row);
+
+    std::vector<quint32> pinTags(const QList<TagPtr>& tags);
+
+    std::pmr::monotonic_buffer_resource m_arena;
+
+    RecordStore m_store;
+    std::pmr::vector<std::weak_ptr<Record>> m_records;
+
+    std::pmr::unordered_map<quint32, TagPtr> m_tags;
+
     QHash<QDate, RecordSetPtr> m_recordsByDate;
     RecordSetPtr m_recordWithoutDate;
 };
@@ -26,11 +26,21 @@ TagsDirectory& Root::tags()
     return m_tags;
 }
 
+TagIndex& Root::tagIndex()
+{
+    return m_tagIndex;
+}
+
 RecordsDirectory& Root::currentPage()
 {
     return m_currentPageRecords;
 }
 
+OperationLog& Root::operations()
+{
+    return m_operations;
+}
+
 QPair<QDate, QDate> Root::currentPageRange()
 {
     return m_currentPageRange;
@@ -44,6 +54,7 @@ void Root::resetCurrentPage(QPair<QDate, QDate> range)
 
     m_currentPageRange = range;
     m_currentPageRecords.clearRecords();
+    m_tags.releaseUnusedTags();
 
     currentPageChanged();
 }
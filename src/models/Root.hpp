@@ -10,7 +10,9 @@
 #pragma once
 
 #include "models/ColorScheme.hpp"
+#include "models/OperationLog.hpp"
 #include "models/RecordsDirectory.hpp"
+#include "models/TagIndex.hpp"
 #include "models/TagsDirectory.hpp"
 
 #include <QDate>
@@ -28,8 +30,13 @@ public:
 
     TagsDirectory& tags();
 
+    TagIndex& tagIndex();
+
     RecordsDirectory& currentPage();
 
+    // saved changes of records, for undo
+    OperationLog& operations();
+
     QPair<QDate, QDate> currentPageRange();
 
     void resetCurrentPage(QPair<QDate, QDate>);
@@ -44,7 +51,9 @@ signals:
 private:
     ColorScheme m_colorScheme;
     TagsDirectory m_tags;
+    TagIndex m_tagIndex;
     RecordsDirectory m_currentPageRecords;
+    OperationLog m_operations;
 
     QPair<QDate, QDate> m_currentPageRange;
     QDate m_currentDate;
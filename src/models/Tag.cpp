@@ -21,17 +21,17 @@ void Tag::unsetDirty()
     m_isDirty = false;
 }
 
-QString Tag::id() const
+quint32 Tag::id() const
 {
     return m_id;
 }
 
 bool Tag::hasID() const
 {
-    return !m_id.isEmpty();
+    return m_id != 0;
 }
 
-void Tag::setID(QString id)
+void Tag::setID(quint32 id)
 {
     if (id == m_id) {
         return;
@@ -40,6 +40,16 @@ void Tag::setID(QString id)
     idChanged(id);
 }
 
+quint32 Tag::handle() const
+{
+    return m_handle;
+}
+
+void Tag::setHandle(quint32 handle)
+{
+    m_handle = handle;
+}
+
 QString Tag::name() const
 {
     return m_name;
@@ -70,13 +80,68 @@ void Tag::setFocused(bool focused)
     focusChanged(focused);
 }
 
+int Tag::colorIndex() const
+{
+    if (m_colorIndex >= 0) {
+        return m_colorIndex;
+    }
+
+    if (!m_colorScheme) {
+        return -1;
+    }
+
+    return m_colorScheme->tagIndex(m_name);
+}
+
+bool Tag::hasColorIndex() const
+{
+    return m_colorIndex >= 0;
+}
+
+void Tag::setColorIndex(int index)
+{
+    if (index == m_colorIndex) {
+        return;
+    }
+    m_isDirty = true;
+    m_colorIndex = index;
+    updateColors();
+}
+
+int Tag::useCount() const
+{
+    return m_useCount;
+}
+
+int Tag::openCount() const
+{
+    return m_openCount;
+}
+
+QDate Tag::lastUsed() const
+{
+    return m_lastUsed;
+}
+
+// doesn't make tag dirty, counters are not saved with tag
+void Tag::setUsage(int useCount, int openCount, const QDate& lastUsed)
+{
+    if (useCount == m_useCount && openCount == m_openCount && lastUsed == m_lastUsed) {
+        return;
+    }
+    m_useCount = useCount;
+    m_openCount = openCount;
+    m_lastUsed = lastUsed;
+    usageChanged();
+}
+
 QHash<QString, QColor> Tag::getColors() const
 {
     if (!m_colorScheme) {
         return {};
     }
 
-    return m_colorScheme->tagColors(m_name);
+    return m_colorScheme->tagColors(colorIndex());
 }
 
 void Tag::setColorScheme(ColorScheme* scheme)
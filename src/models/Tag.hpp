@@ -11,6 +11,7 @@
 
 #include "models/ColorScheme.hpp"
 
+#include <QDate>
 #include <QHash>
 #include <QObject>
 #include <QString>
@@ -26,14 +27,30 @@ public:
     bool isDirty() const;
     void unsetDirty();
 
-    QString id() const;
+    // sqlite rowid, zero if tag is not saved yet
+    quint32 id() const;
     bool hasID() const;
-    void setID(QString);
+    void setID(quint32);
+
+    // dense number given by TagsDirectory, unique among loaded tags
+    quint32 handle() const;
+    void setHandle(quint32);
 
     QString name() const;
 
     bool isFocused() const;
 
+    // pinned palette index, or one derived from name if not pinned
+    int colorIndex() const;
+    bool hasColorIndex() const;
+    void setColorIndex(int);
+
+    // usage counters, maintained by storage
+    int useCount() const;
+    int openCount() const;
+    QDate lastUsed() const;
+    void setUsage(int useCount, int openCount, const QDate& lastUsed);
+
     QHash<QString, QColor> getColors() const;
     void setColorScheme(ColorScheme*);
 
@@ -42,10 +59,11 @@ public slots:
     void setFocused(bool);
 
 signals:
-    void idChanged(QString);
+    void idChanged(quint32);
     void nameChanged(QString);
     void focusChanged(bool);
     void colorsChanged(QHash<QString, QColor>);
+    void usageChanged();
 
 private slots:
     void updateColors();
@@ -53,9 +71,15 @@ private slots:
 private:
     bool m_isDirty { true };
 
-    QString m_id;
+    quint32 m_id {};
+    quint32 m_handle {};
     QString m_name;
     bool m_focused { false };
+    int m_colorIndex { -1 };
+
+    int m_useCount {};
+    int m_openCount {};
+    QDate m_lastUsed;
 
     ColorScheme* m_colorScheme {};
 };
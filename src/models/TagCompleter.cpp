@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "models/TagCompleter.hpp"
+
+#include <algorithm>
+#include <queue>
+#include <tuple>
+
+namespace tagberry::models {
+
+void TagCompleter::clear()
+{
+    m_entries.clear();
+    m_indexByName.clear();
+    m_tree.clear();
+    m_leafCount = 0;
+    m_dirty = false;
+}
+
+void TagCompleter::insert(const QString& name, int weight)
+{
+    auto it = m_indexByName.find(name);
+
+    if (it != m_indexByName.end()) {
+        auto& entry = m_entries[size_t(it.value())];
+        if (entry.weight != weight) {
+            entry.weight = weight;
+            if (!m_dirty) {
+                updateTree(it.value());
+            }
+        }
+        return;
+    }
+
+    m_indexByName[name] = int(m_entries.size());
+    m_entries.push_back(Entry { name.toCaseFolded(), name, weight });
+    m_dirty = true;
+}
+
+void TagCompleter::remove(const QString& name)
+{
+    auto it = m_indexByName.find(name);
+    if (it == m_indexByName.end()) {
+        return;
+    }
+
+    const auto index = size_t(it.value());
+    m_indexByName.erase(it);
+
+    if (index + 1 != m_entries.size()) {
+        std::swap(m_entries[index], m_entries.back());
+        m_indexByName[m_entries[index].name] = int(index);
+    }
+
+    m_entries.pop_back();
+    m_dirty = true;
+}
+
+int TagCompleter::count() const
+{
+    return int(m_entries.size());
+}
+
+QStringList TagCompleter::complete(const QString& prefix, int limit) const
+{
+    QStringList ret;
+
+    if (limit <= 0) {
+        return ret;
+    }
+
+    rebuild();
+
+    const auto key = prefix.toCaseFolded();
+
+    auto begin = std::lower_bound(m_entries.begin(), m_entries.end(), key,
+        [](const Entry& e, const QString& k) { return e.key < k; });
+
+    auto end = std::partition_point(
+        begin, m_entries.end(), [&](const Entry& e) { return e.key.startsWith(key); });
+
+    if (begin == end) {
+        return ret;
+    }
+
+    // each heap item is (best index, range), popping best splits its range in two
+    using Item = std::tuple<int, int, int>;
+
+    auto worse = [&](const Item& a, const Item& b) {
+        return better(std::get<0>(a), std::get<0>(b)) != std::get<0>(a);
+    };
+
+    std::priority_queue<Item, std::vector<Item>, decltype(worse)> heap(worse);
+
+    auto push = [&](int from, int to) {
+        if (from <= to) {
+            heap.emplace(rangeBest(from, to), from, to);
+        }
+    };
+
+    push(int(begin - m_entries.begin()), int(end - m_entries.begin()) - 1);
+
+    while (!heap.empty() && ret.size() < limit) {
+        auto [best, from, to] = heap.top();
+        heap.pop();
+
+        ret.append(m_entries[size_t(best)].name);
+
+        push(from, best - 1);
+        push(best + 1, to);
+    }
+
+    return ret;
+}
+
+void TagCompleter::rebuild() const
+{
+    if (!m_dirty) {
+        return;
+    }
+
+    std::sort(m_entries.begin(), m_entries.end(),
+        [](const Entry& a, const Entry& b) { return a.key < b.key; });
+
+    m_indexByName.clear();
+    for (size_t n = 0; n < m_entries.size(); n++) {
+        m_indexByName[m_entries[n].name] = int(n);
+    }
+
+    m_leafCount = 1;
+    while (m_leafCount < int(m_entries.size())) {
+        m_leafCount *= 2;
+    }
+
+    m_tree.assign(size_t(m_leafCount) * 2, -1);
+
+    for (int n = 0; n < int(m_entries.size()); n++) {
+        m_tree[size_t(m_leafCount + n)] = n;
+    }
+    for (int n = m_leafCount - 1; n > 0; n--) {
+        m_tree[size_t(n)] = better(m_tree[size_t(2 * n)], m_tree[size_t(2 * n + 1)]);
+    }
+
+    m_dirty = false;
+}
+
+// higher weight wins, then alphabetical order
+int TagCompleter::better(int a, int b) const
+{
+    if (a < 0 || b < 0) {
+        return a < 0 ? b : a;
+    }
+
+    const auto wa = m_entries[size_t(a)].weight;
+    const auto wb = m_entries[size_t(b)].weight;
+
+    if (wa != wb) {
+        return wa > wb ? a : b;
+    }
+
+    return a < b ? a : b;
+}
+
+// best entry in [from; to]
+int TagCompleter::rangeBest(int from, int to) const
+{
+    int ret = -1;
+
+    for (int l = from + m_leafCount, r = to + m_leafCount + 1; l < r; l /= 2, r /= 2) {
+        if (l & 1) {
+            ret = better(ret, m_tree[size_t(l++)]);
+        }
+        if (r & 1) {
+            ret = better(ret, m_tree[size_t(--r)]);
+        }
+    }
+
+    return ret;
+}
+
+void TagCompleter::updateTree(int index) const
+{
+    for (int n = (index + m_leafCount) / 2; n > 0; n /= 2) {
+        m_tree[size_t(n)] = better(m_tree[size_t(2 * n)], m_tree[size_t(2 * n + 1)]);
+    }
+}
+
+} // namespace tagberry::models
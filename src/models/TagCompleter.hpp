@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+namespace tagberry::models {
+
+// Case-insensitive prefix completion of tag names, most used first.
+// Names are kept sorted, so that names with given prefix form a range,
+// and a max-tree over weights gives top-k of that range in O(k log n).
+class TagCompleter {
+public:
+    void clear();
+
+    // adds name or updates its weight
+    void insert(const QString& name, int weight);
+    void remove(const QString& name);
+
+    int count() const;
+
+    QStringList complete(const QString& prefix, int limit) const;
+
+private:
+    struct Entry {
+        QString key;
+        QString name;
+        int weight {};
+    };
+
+    // sorts entries and builds tree, if names were added or removed
+    void rebuild() const;
+
+    int better(int a, int b) const;
+    int rangeBest(int from, int to) const;
+    void updateTree(int index) const;
+
+    mutable std::vector<Entry> m_entries;
+    mutable QHash<QString, int> m_indexByName;
+
+    mutable std::vector<int> m_tree;
+    mutable int m_leafCount {};
+    mutable bool m_dirty {};
+};
+
+} // namespace tagberry::models
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "models/TagIndex.hpp"
+
+#include <limits>
+
+namespace tagberry::models {
+
+void TagIndex::clear()
+{
+    m_records.clear();
+    m_tags.clear();
+    m_allRecords.clear();
+    m_incompleteRecords.clear();
+    m_allDays.clear();
+    m_dayCounts.clear();
+}
+
+void TagIndex::setRecord(quint32 recordID, const QDate& date, bool complete)
+{
+    removeRecord(recordID);
+
+    auto& entry = m_records[recordID];
+    entry.day = date.isValid() ? quint32(date.toJulianDay()) : 0;
+
+    m_allRecords.add(recordID);
+    if (!complete) {
+        m_incompleteRecords.add(recordID);
+    }
+
+    // records without date are counted, but are not on any day
+    if (entry.day) {
+        addDay(m_allDays, m_dayCounts, entry.day);
+    }
+}
+
+void TagIndex::addRecordTag(quint32 recordID, quint32 tagID)
+{
+    auto it = m_records.find(recordID);
+    if (it == m_records.end() || it->tags.contains(tagID)) {
+        return;
+    }
+
+    it->tags.append(tagID);
+
+    auto& tag = m_tags[tagID];
+
+    tag.records.add(recordID);
+    if (it->day) {
+        addDay(tag.days, tag.dayCounts, it->day);
+    }
+}
+
+void TagIndex::removeRecord(quint32 recordID)
+{
+    auto it = m_records.find(recordID);
+    if (it == m_records.end()) {
+        return;
+    }
+
+    for (auto tagID : it->tags) {
+        auto tagIt = m_tags.find(tagID);
+        if (tagIt == m_tags.end()) {
+            continue;
+        }
+
+        tagIt->records.remove(recordID);
+        if (it->day) {
+            removeDay(tagIt->days, tagIt->dayCounts, it->day);
+        }
+
+        if (tagIt->records.isEmpty()) {
+            m_tags.erase(tagIt);
+        }
+    }
+
+    if (it->day) {
+        removeDay(m_allDays, m_dayCounts, it->day);
+    }
+
+    m_allRecords.remove(recordID);
+    m_incompleteRecords.remove(recordID);
+
+    m_records.erase(it);
+}
+
+int TagIndex::recordCount() const
+{
+    return m_records.size();
+}
+
+Bitmap TagIndex::allRecords() const
+{
+    return m_allRecords;
+}
+
+Bitmap TagIndex::incompleteRecords() const
+{
+    return m_incompleteRecords;
+}
+
+Bitmap TagIndex::recordsWithTag(quint32 tagID) const
+{
+    auto it = m_tags.find(tagID);
+    if (it == m_tags.end()) {
+        return {};
+    }
+    return it->records;
+}
+
+Bitmap TagIndex::allDays() const
+{
+    return m_allDays;
+}
+
+Bitmap TagIndex::daysWithTag(quint32 tagID) const
+{
+    auto it = m_tags.find(tagID);
+    if (it == m_tags.end()) {
+        return {};
+    }
+    return it->days;
+}
+
+QList<QDate> TagIndex::findDates(const QList<quint32>& withTags,
+    const QList<quint32>& withoutTags, const QDate& from, const QDate& to) const
+{
+    const auto first = from.isValid() ? quint32(from.toJulianDay()) : 0;
+    const auto last = to.isValid() ? quint32(to.toJulianDay())
+                                   : std::numeric_limits<quint32>::max();
+
+    auto days = m_allDays.range(first, last);
+
+    for (auto tagID : withTags) {
+        days.intersect(daysWithTag(tagID));
+    }
+
+    for (auto tagID : withoutTags) {
+        days.subtract(daysWithTag(tagID));
+    }
+
+    QList<QDate> ret;
+    days.forEach([&](quint32 day) { ret.append(QDate::fromJulianDay(day)); });
+
+    return ret;
+}
+
+quint64 TagIndex::countRecords(const QList<quint32>& withTags,
+    const QList<quint32>& withoutTags, bool incompleteOnly) const
+{
+    auto records = incompleteOnly ? m_incompleteRecords : m_allRecords;
+
+    for (auto tagID : withTags) {
+        records.intersect(recordsWithTag(tagID));
+    }
+
+    for (auto tagID : withoutTags) {
+        records.subtract(recordsWithTag(tagID));
+    }
+
+    return records.count();
+}
+
+void TagIndex::addDay(Bitmap& days, QHash<quint32, int>& dayCounts, quint32 day)
+{
+    if (dayCounts[day]++ == 0) {
+        days.add(day);
+    }
+}
+
+void TagIndex::removeDay(Bitmap& days, QHash<quint32, int>& dayCounts, quint32 day)
+{
+    auto it = dayCounts.find(day);
+    if (it == dayCounts.end()) {
+        return;
+    }
+    if (--it.value() == 0) {
+        dayCounts.erase(it);
+        days.remove(day);
+    }
+}
+
+} // namespace tagberry::models
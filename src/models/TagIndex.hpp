@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "models/Bitmap.hpp"
+
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+namespace tagberry::models {
+
+// In-memory inverted index from tags to records and days, covering the
+// whole database, not only the current page. Filled by storage on first
+// query and kept up to date on every record write since.
+class TagIndex {
+public:
+    void clear();
+
+    // (re)registers record without tags
+    void setRecord(quint32 recordID, const QDate& date, bool complete);
+    void addRecordTag(quint32 recordID, quint32 tagID);
+    void removeRecord(quint32 recordID);
+
+    int recordCount() const;
+
+    Bitmap allRecords() const;
+    Bitmap incompleteRecords() const;
+    Bitmap recordsWithTag(quint32 tagID) const;
+
+    // days are julian day numbers
+    Bitmap allDays() const;
+    Bitmap daysWithTag(quint32 tagID) const;
+
+    // days in [from; to] (open if invalid) having a record with each of withTags,
+    // and no record with any of withoutTags
+    QList<QDate> findDates(const QList<quint32>& withTags,
+        const QList<quint32>& withoutTags, const QDate& from, const QDate& to) const;
+
+    // records having all of withTags and none of withoutTags
+    quint64 countRecords(const QList<quint32>& withTags,
+        const QList<quint32>& withoutTags, bool incompleteOnly) const;
+
+private:
+    struct RecordEntry {
+        // julian day, 0 for records without date
+        quint32 day {};
+        QVector<quint32> tags;
+    };
+
+    struct TagEntry {
+        Bitmap records;
+        Bitmap days;
+        QHash<quint32, int> dayCounts;
+    };
+
+    static void addDay(Bitmap& days, QHash<quint32, int>& dayCounts, quint32 day);
+    static void removeDay(Bitmap& days, QHash<quint32, int>& dayCounts, quint32 day);
+
+    QHash<quint32, RecordEntry> m_records;
+    QHash<quint32, TagEntry> m_tags;
+
+    Bitmap m_allRecords;
+    Bitmap m_incompleteRecords;
+
+    Bitmap m_allDays;
+    QHash<quint32, int> m_dayCounts;
+};
+
+} // namespace tagberry::models
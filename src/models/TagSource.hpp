@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "models/Tag.hpp"
+
+#include <QString>
+
+namespace tagberry::models {
+
+class TagsDirectory;
+
+// Backing store for TagsDirectory, which keeps only tags in use and asks
+// source for the rest. Found tag is created in given directory; null is
+// returned if there is no such tag.
+class TagSource {
+public:
+    virtual ~TagSource() = default;
+
+    virtual TagPtr loadTagByID(TagsDirectory& tagDir, quint32 id) = 0;
+    virtual TagPtr loadTagByName(TagsDirectory& tagDir, const QString& name) = 0;
+};
+
+} // namespace tagberry::models
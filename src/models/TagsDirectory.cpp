@@ -11,14 +11,82 @@
 
 namespace tagberry::models {
 
+namespace {
+
+const quint32 noHandle = quint32(-1);
+
+} // namespace
+
+void TagsDirectory::setSource(TagSource* source)
+{
+    m_source = source;
+}
+
 QList<TagPtr> TagsDirectory::getTags() const
 {
-    return m_tagByID.values();
+    QList<TagPtr> tags;
+    for (const auto& slot : m_slots) {
+        if (slot.tag) {
+            tags.append(slot.tag);
+        }
+    }
+    return tags;
 }
 
-TagPtr TagsDirectory::getTagByName(const QString& name) const
+TagPtr TagsDirectory::getTagByName(const QString& name)
 {
-    return m_tagByName[name];
+    auto it = m_handleByName.constFind(name);
+    if (it != m_handleByName.constEnd()) {
+        return m_slots[it.value()].tag;
+    }
+
+    if (!m_source || name.isEmpty()) {
+        return {};
+    }
+
+    return m_source->loadTagByName(*this, name);
+}
+
+TagPtr TagsDirectory::getTagByID(quint32 id)
+{
+    if (auto tag = getLoadedTagByID(id)) {
+        return tag;
+    }
+
+    if (!m_source || !id) {
+        return {};
+    }
+
+    return m_source->loadTagByID(*this, id);
+}
+
+TagPtr TagsDirectory::getLoadedTagByID(quint32 id) const
+{
+    auto it = m_handleByID.constFind(id);
+    if (it == m_handleByID.constEnd()) {
+        return {};
+    }
+
+    return m_slots[it.value()].tag;
+}
+
+TagPtr TagsDirectory::getTagByHandle(quint32 handle) const
+{
+    if (handle >= m_slots.size()) {
+        return {};
+    }
+
+    return m_slots[handle].tag;
+}
+
+QStringList TagsDirectory::completeTagName(const QString& prefix, int limit) const
+{
+    return m_completer.complete(prefix, limit);
+}
+
+void TagsDirectory::indexTagName(const QString& name, int useCount)
+{
+    m_completer.insert(name, useCount);
 }
 
 TagPtr TagsDirectory::createTag()
@@ -32,15 +100,27 @@ TagPtr TagsDirectory::createTag()
     connect(tag.get(), &Tag::idChanged, this, &TagsDirectory::tagIdChanged);
     connect(tag.get(), &Tag::nameChanged, this, &TagsDirectory::tagNameChanged);
     connect(tag.get(), &Tag::focusChanged, this, &TagsDirectory::tagFocusChanged);
+    connect(tag.get(), &Tag::usageChanged, this, &TagsDirectory::tagUsageChanged);
 
-    m_tags.insert(tag);
+    quint32 handle;
+
+    if (!m_freeHandles.empty()) {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+    } else {
+        handle = quint32(m_slots.size());
+        m_slots.emplace_back();
+    }
+
+    tag->setHandle(handle);
+    m_slots[handle].tag = tag;
 
     return tag;
 }
 
-TagPtr TagsDirectory::getOrCreateTag(const QString& id)
+TagPtr TagsDirectory::getOrCreateTag(quint32 id)
 {
-    if (auto tag = m_tagByID[id]) {
+    if (auto tag = getLoadedTagByID(id)) {
         return tag;
     }
 
@@ -50,20 +130,38 @@ TagPtr TagsDirectory::getOrCreateTag(const QString& id)
     return tag;
 }
 
-void TagsDirectory::removeTag(TagPtr tag)
+void TagsDirectory::unindexTag(quint32 handle)
 {
-    disconnect(tag.get(), nullptr, this, nullptr);
+    auto& slot = m_slots[handle];
+
+    disconnect(slot.tag.get(), nullptr, this, nullptr);
+
+    if (slot.id && m_handleByID.value(slot.id, noHandle) == handle) {
+        m_handleByID.remove(slot.id);
+    }
+
+    if (!slot.name.isEmpty() && m_handleByName.value(slot.name, noHandle) == handle) {
+        m_handleByName.remove(slot.name);
+    }
+
+    slot = Slot();
+    m_freeHandles.push_back(handle);
+}
 
-    m_tags.erase(tag);
+void TagsDirectory::removeTag(TagPtr tag)
+{
+    const auto handle = tag->handle();
 
-    if (!tag->id().isEmpty()) {
-        m_tagByID.remove(tag->id());
+    if (getTagByHandle(handle) != tag) {
+        return;
     }
 
     if (!tag->name().isEmpty()) {
-        m_tagByName.remove(tag->name());
+        m_completer.remove(tag->name());
     }
 
+    unindexTag(handle);
+
     if (m_focusedTag == tag) {
         m_focusedTag.reset();
     }
@@ -85,56 +183,93 @@ void TagsDirectory::focusTag(TagPtr focusedTag)
 
 void TagsDirectory::clearTags()
 {
-    for (auto tag : m_tags) {
-        disconnect(tag.get(), nullptr, this, nullptr);
+    for (const auto& slot : m_slots) {
+        if (slot.tag) {
+            disconnect(slot.tag.get(), nullptr, this, nullptr);
+        }
     }
 
-    m_tagByName.clear();
-    m_tagByID.clear();
+    m_slots.clear();
+    m_freeHandles.clear();
 
-    m_tags.clear();
+    m_handleByName.clear();
+    m_handleByID.clear();
+    m_completer.clear();
 
     m_focusedTag.reset();
 }
 
+void TagsDirectory::releaseUnusedTags()
+{
+    for (quint32 handle = 0; handle < m_slots.size(); handle++) {
+        const auto& tag = m_slots[handle].tag;
+
+        if (!tag || tag->isDirty() || !tag->hasID() || tag == m_focusedTag) {
+            continue;
+        }
+
+        // slot holds the only reference
+        if (tag.use_count() > 1) {
+            continue;
+        }
+
+        unindexTag(handle);
+    }
+}
+
 void TagsDirectory::setColorScheme(ColorScheme* colorScheme)
 {
     m_colorScheme = colorScheme;
 
-    for (auto tag : m_tags) {
-        tag->setColorScheme(m_colorScheme);
+    for (const auto& slot : m_slots) {
+        if (slot.tag) {
+            slot.tag->setColorScheme(m_colorScheme);
+        }
     }
 }
 
-void TagsDirectory::tagIdChanged(QString id)
+void TagsDirectory::tagIdChanged(quint32 id)
 {
     auto tag = qobject_cast<Tag*>(sender());
+    const auto handle = tag->handle();
+    auto& slot = m_slots[handle];
 
-    for (auto it = m_tagByID.begin(); it != m_tagByID.end(); ++it) {
-        if (it.value().get() == tag) {
-            m_tagByID.erase(it);
-            break;
-        }
+    if (slot.id && m_handleByID.value(slot.id, noHandle) == handle) {
+        m_handleByID.remove(slot.id);
     }
 
-    if (!id.isEmpty()) {
-        m_tagByID[id] = tag->shared_from_this();
+    slot.id = id;
+
+    if (id) {
+        m_handleByID[id] = handle;
     }
 }
 
 void TagsDirectory::tagNameChanged(QString text)
 {
     auto tag = qobject_cast<Tag*>(sender());
+    const auto handle = tag->handle();
+    auto& slot = m_slots[handle];
 
-    for (auto it = m_tagByName.begin(); it != m_tagByName.end(); ++it) {
-        if (it.value().get() == tag) {
-            m_tagByName.erase(it);
-            break;
-        }
+    if (!slot.name.isEmpty() && m_handleByName.value(slot.name, noHandle) == handle) {
+        m_completer.remove(slot.name);
+        m_handleByName.remove(slot.name);
     }
 
+    slot.name = text;
+
     if (!text.isEmpty()) {
-        m_tagByName[text] = tag->shared_from_this();
+        m_handleByName[text] = handle;
+        m_completer.insert(text, tag->useCount());
+    }
+}
+
+void TagsDirectory::tagUsageChanged()
+{
+    auto tag = qobject_cast<Tag*>(sender());
+
+    if (m_handleByName.value(tag->name(), noHandle) == tag->handle()) {
+        m_completer.insert(tag->name(), tag->useCount());
     }
 }
 
@@ -11,27 +11,48 @@
 
 #include "models/ColorScheme.hpp"
 #include "models/Tag.hpp"
+#include "models/TagCompleter.hpp"
+#include "models/TagSource.hpp"
 
 #include <QHash>
 #include <QList>
 #include <QObject>
 #include <QString>
+#include <QStringList>
 
-#include <unordered_set>
+#include <vector>
 
 namespace tagberry::models {
 
+// Tags are loaded from source on demand and released when nothing else
+// holds them. Only names with use counts stay resident, for completion.
+// Loaded tags are numbered by dense handles, free handles are reused.
 class TagsDirectory : public QObject {
     Q_OBJECT
 
 public:
+    void setSource(TagSource*);
+
+    // currently loaded tags
     QList<TagPtr> getTags() const;
 
-    TagPtr getTagByName(const QString& name) const;
+    // load tag from source if it's not loaded yet
+    TagPtr getTagByName(const QString& name);
+    TagPtr getTagByID(quint32 id);
+
+    // only if already loaded
+    TagPtr getLoadedTagByID(quint32 id) const;
+    TagPtr getTagByHandle(quint32 handle) const;
+
+    // names starting with prefix, most used first
+    QStringList completeTagName(const QString& prefix, int limit) const;
+
+    // adds name to completion index without loading tag
+    void indexTagName(const QString& name, int useCount);
 
     TagPtr createTag();
 
-    TagPtr getOrCreateTag(const QString& id);
+    TagPtr getOrCreateTag(quint32 id);
 
     void removeTag(TagPtr);
 
@@ -39,18 +60,36 @@ public:
 
     void clearTags();
 
+    // drops saved tags not referenced from outside of directory
+    void releaseUnusedTags();
+
     void setColorScheme(ColorScheme*);
 
 private slots:
-    virtual void tagIdChanged(QString);
+    virtual void tagIdChanged(quint32);
     virtual void tagNameChanged(QString);
     virtual void tagFocusChanged(bool);
+    virtual void tagUsageChanged();
 
 private:
-    std::unordered_set<TagPtr> m_tags;
+    // keys under which tag is indexed, to unindex it on change
+    struct Slot {
+        TagPtr tag;
+        quint32 id {};
+        QString name;
+    };
+
+    void unindexTag(quint32 handle);
+
+    std::vector<Slot> m_slots;
+    std::vector<quint32> m_freeHandles;
+
+    QHash<quint32, quint32> m_handleByID;
+    QHash<QString, quint32> m_handleByName;
+
+    TagCompleter m_completer;
 
-    QHash<QString, TagPtr> m_tagByName;
-    QHash<QString, TagPtr> m_tagByID;
+    TagSource* m_source {};
 
     ColorScheme* m_colorScheme {};
 
@@ -8,6 +8,7 @@
  */
 
 #include "presenters/CalendarArea.hpp"
+#include "trace/Trace.hpp"
 
 namespace tagberry::presenters {
 
@@ -25,6 +26,9 @@ CalendarArea::CalendarArea(storage::LocalStorage& storage, models::Root& root)
     connect(
         m_calendar, &widgets::TagCalendar::pageChanged, this, &CalendarArea::refreshPage);
 
+    connect(&m_storage, &storage::LocalStorage::recordsChangedExternally, this,
+        &CalendarArea::reloadRecords);
+
     connect(m_calendar, &widgets::TagCalendar::currentDateChanged, this,
         &CalendarArea::changeCurrentDate);
 
@@ -49,6 +53,11 @@ int CalendarArea::headerHeight()
     return m_calendar->headerHeight();
 }
 
+void CalendarArea::showDate(QDate date)
+{
+    m_calendar->setCurrentDate(date);
+}
+
 void CalendarArea::changeCurrentDate(QDate date)
 {
     m_root.setCurrentDate(date);
@@ -65,13 +74,13 @@ void CalendarArea::changeTagFocus(widgets::TagLabel* label)
         return;
     }
 
-    auto tag = m_root.tags().getTagByName(label->text());
-
-    m_root.tags().focusTag(tag);
+    m_root.tags().focusTag(labelTag(label));
 }
 
 void CalendarArea::refreshPage()
 {
+    TRACE_SPAN("CalendarArea::refreshPage");
+
     m_calendar->clearTags();
 
     auto range = m_calendar->getVisibleRange();
@@ -92,8 +101,16 @@ void CalendarArea::refreshPage()
     m_storage.readPage(range, m_root.currentPage(), m_root.tags());
 }
 
+void CalendarArea::reloadRecords(QList<quint32> changedIDs, QList<quint32> removedIDs)
+{
+    m_storage.reloadRecords(m_calendar->getVisibleRange(), changedIDs, removedIDs,
+        m_root.currentPage(), m_root.tags());
+}
+
 void CalendarArea::rebuildCell(QDate date)
 {
+    TRACE_SPAN("CalendarArea::rebuildCell");
+
     m_calendar->clearTags(date);
 
     auto recSet = m_root.currentPage().recordsByDate(date);
@@ -116,6 +133,9 @@ void CalendarArea::rebuildCell(QDate date)
 
         label->setColors(tag->getColors());
 
+        m_labelTags[label] = tag->handle();
+        connect(label, &QObject::destroyed, this, [=] { m_labelTags.remove(label); });
+
         m_calendar->addTag(date, label);
     }
 }
@@ -125,9 +145,20 @@ void CalendarArea::updateCellStates(QDate date)
     auto recSet = m_root.currentPage().recordsByDate(date);
 
     for (auto label : m_calendar->getTags(date)) {
-        auto tag = m_root.tags().getTagByName(label->text());
-        label->setComplete(recSet->checkAllRecordsWithTagComplete(tag));
+        if (auto tag = labelTag(label)) {
+            label->setComplete(recSet->checkAllRecordsWithTagComplete(tag));
+        }
+    }
+}
+
+models::TagPtr CalendarArea::labelTag(const widgets::TagLabel* label) const
+{
+    auto it = m_labelTags.constFind(label);
+    if (it == m_labelTags.constEnd()) {
+        return {};
     }
+
+    return m_root.tags().getTagByHandle(it.value());
 }
 
 } // namespace tagberry::presenters
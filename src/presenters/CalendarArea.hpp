@@ -14,6 +14,7 @@
 #include "widgets/TagCalendar.hpp"
 
 #include <QHBoxLayout>
+#include <QHash>
 #include <QWidget>
 
 namespace tagberry::presenters {
@@ -26,6 +27,12 @@ public:
 
     int headerHeight();
 
+public slots:
+    void showDate(QDate);
+
+    // only changed records are re-read, cells and editors follow record sets
+    void reloadRecords(QList<quint32> changedIDs, QList<quint32> removedIDs);
+
 signals:
     void focusTaken();
 
@@ -41,6 +48,8 @@ private:
     void rebuildCell(QDate);
     void updateCellStates(QDate);
 
+    models::TagPtr labelTag(const widgets::TagLabel*) const;
+
 private:
     QHBoxLayout* m_layout;
     widgets::TagCalendar* m_calendar;
@@ -48,6 +57,9 @@ private:
     storage::LocalStorage& m_storage;
 
     models::Root& m_root;
+
+    // tag handles of labels, to avoid lookups by label text
+    QHash<const widgets::TagLabel*, quint32> m_labelTags;
 };
 
 } // namespace tagberry::presenters
@@ -9,38 +9,150 @@
 
 #include "presenters/MainWindow.hpp"
 
+#include <QAction>
+#include <QTimer>
+
 namespace tagberry::presenters {
 
 MainWindow::MainWindow(storage::LocalStorage& storage)
     : m_storage(storage)
     , m_layout(new QHBoxLayout)
+    , m_sideLayout(new QVBoxLayout)
     , m_widget(new QWidget(this))
 {
-    m_storage.readAllTags(m_root.tags());
+    m_root.tags().setSource(&m_storage);
 
     m_calendarArea = new CalendarArea(m_storage, m_root);
+    m_searchArea = new SearchArea(m_storage, m_root);
     m_recordsArea = new RecordsArea(m_storage, m_root);
+    m_yearArea = new YearArea(m_storage, m_root);
+    m_tagStatsArea = new TagStatsArea(m_storage, m_root);
+    m_scriptServer = new ScriptServer(m_storage, m_root);
+    m_scriptServer->setParent(this);
+    m_undoHistory = new UndoHistory(m_storage, m_root);
+    m_undoHistory->setParent(this);
 
     m_layout->setContentsMargins(QMargins(4, 0, 10, 0));
 
+    m_sideLayout->setContentsMargins(QMargins(0, 9, 0, 0));
+    m_sideLayout->setSpacing(0);
+    m_sideLayout->addWidget(m_searchArea);
+    m_sideLayout->addWidget(m_recordsArea, 1);
+
     m_layout->addWidget(m_calendarArea, 4);
-    m_layout->addWidget(m_recordsArea, 1);
+    m_layout->addLayout(m_sideLayout, 1);
 
     m_widget->setLayout(m_layout);
 
     setCentralWidget(m_widget);
     setWindowTitle("Tagberry");
 
+    m_yearDock = new QDockWidget("Year", this);
+    m_yearDock->setObjectName("YearDock");
+    m_yearDock->setAllowedAreas(Qt::TopDockWidgetArea | Qt::BottomDockWidgetArea);
+    m_yearDock->setWidget(m_yearArea);
+    m_yearDock->hide();
+
+    addDockWidget(Qt::BottomDockWidgetArea, m_yearDock);
+
+    auto yearAction = m_yearDock->toggleViewAction();
+    yearAction->setShortcut(QKeySequence("Ctrl+Y"));
+    addAction(yearAction);
+
+    m_tagStatsDock = new QDockWidget("Tags", this);
+    m_tagStatsDock->setObjectName("TagStatsDock");
+    m_tagStatsDock->setAllowedAreas(Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea);
+    m_tagStatsDock->setWidget(m_tagStatsArea);
+    m_tagStatsDock->hide();
+
+    addDockWidget(Qt::RightDockWidgetArea, m_tagStatsDock);
+
+    auto tagStatsAction = m_tagStatsDock->toggleViewAction();
+    tagStatsAction->setShortcut(QKeySequence("Ctrl+T"));
+    addAction(tagStatsAction);
+
+    // text fields handle these keys themselves while focused
+    auto undoAction = new QAction("Undo", this);
+    undoAction->setShortcut(QKeySequence::Undo);
+    connect(undoAction, &QAction::triggered, m_undoHistory, &UndoHistory::undo);
+    addAction(undoAction);
+
+    auto redoAction = new QAction("Redo", this);
+    redoAction->setShortcut(QKeySequence::Redo);
+    connect(redoAction, &QAction::triggered, m_undoHistory, &UndoHistory::redo);
+    addAction(redoAction);
+
     connect(m_calendarArea, &CalendarArea::focusTaken, m_recordsArea,
         &RecordsArea::clearFocus);
 
+    connect(m_scriptServer, &ScriptServer::recordsChanged, m_calendarArea,
+        &CalendarArea::reloadRecords);
+
+    connect(m_undoHistory, &UndoHistory::recordsChanged, m_calendarArea,
+        &CalendarArea::reloadRecords);
+
+    connect(m_searchArea, &SearchArea::dateActivated, m_calendarArea,
+        &CalendarArea::showDate);
+
+    connect(m_yearArea, &YearArea::dateActivated, m_calendarArea,
+        &CalendarArea::showDate);
+
+    connect(&m_storage, &storage::LocalStorage::tagStatsChanged, this,
+        &MainWindow::updateTagUsage);
+
+    connect(m_searchArea, &SearchArea::activeChanged, this, [=](bool active) {
+        m_recordsArea->setHidden(active);
+        alignHeader();
+    });
+
     m_calendarArea->setFocus();
 }
 
+void MainWindow::loadDeferred()
+{
+    m_storage.readTagNames(m_root.tags());
+}
+
+bool MainWindow::listenScripts(const QString& name)
+{
+    return m_scriptServer->listen(name);
+}
+
+void MainWindow::paintEvent(QPaintEvent* event)
+{
+    QMainWindow::paintEvent(event);
+
+    if (!m_painted) {
+        m_painted = true;
+        QTimer::singleShot(0, this, &MainWindow::firstPainted);
+    }
+}
+
 void MainWindow::resizeEvent(QResizeEvent* event)
 {
     QMainWindow::resizeEvent(event);
-    m_recordsArea->setHeaderHeight(m_calendarArea->headerHeight());
+    alignHeader();
+}
+
+void MainWindow::updateTagUsage(quint32 tagID)
+{
+    storage::TagStats stats;
+
+    if (!m_storage.readTagStats(tagID, stats)) {
+        return;
+    }
+
+    if (auto tag = m_root.tags().getLoadedTagByID(tagID)) {
+        tag->setUsage(stats.total, stats.open, stats.lastUsed);
+    } else {
+        m_root.tags().indexTagName(stats.name, stats.total);
+    }
+}
+
+void MainWindow::alignHeader()
+{
+    m_recordsArea->setHeaderHeight(m_calendarArea->headerHeight()
+        - m_sideLayout->contentsMargins().top() - m_searchArea->sizeHint().height());
 }
 
 } // namespace tagberry::presenters
@@ -12,10 +12,17 @@
 #include "models/Root.hpp"
 #include "presenters/CalendarArea.hpp"
 #include "presenters/RecordsArea.hpp"
+#include "presenters/ScriptServer.hpp"
+#include "presenters/SearchArea.hpp"
+#include "presenters/TagStatsArea.hpp"
+#include "presenters/UndoHistory.hpp"
+#include "presenters/YearArea.hpp"
 #include "storage/LocalStorage.hpp"
 
+#include <QDockWidget>
 #include <QHBoxLayout>
 #include <QMainWindow>
+#include <QVBoxLayout>
 
 namespace tagberry::presenters {
 
@@ -25,19 +32,49 @@ class MainWindow : public QMainWindow {
 public:
     explicit MainWindow(storage::LocalStorage& storage);
 
+    // loads data not needed for first page: tag names for completion; tag
+    // index is built on first script query
+    void loadDeferred();
+
+    // starts accepting requests from scripts on local socket
+    bool listenScripts(const QString& name);
+
+signals:
+    // emitted from event loop after window was painted first time
+    void firstPainted();
+
 protected:
     void resizeEvent(QResizeEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+
+private slots:
+    void updateTagUsage(quint32 tagID);
 
 private:
+    void alignHeader();
+
     storage::LocalStorage& m_storage;
 
     models::Root m_root;
 
     QHBoxLayout* m_layout;
+    QVBoxLayout* m_sideLayout;
     QWidget* m_widget;
 
     CalendarArea* m_calendarArea {};
+    SearchArea* m_searchArea {};
     RecordsArea* m_recordsArea {};
+
+    ScriptServer* m_scriptServer {};
+    UndoHistory* m_undoHistory {};
+
+    bool m_painted {};
+
+    QDockWidget* m_yearDock {};
+    YearArea* m_yearArea {};
+
+    QDockWidget* m_tagStatsDock {};
+    TagStatsArea* m_tagStatsArea {};
 };
 
 } // namespace tagberry::presenters
@@ -8,6 +8,7 @@
  */
 
 #include "presenters/RecordsArea.hpp"
+#include "trace/Trace.hpp"
 
 namespace tagberry::presenters {
 
@@ -43,6 +44,8 @@ void RecordsArea::setHeaderHeight(int h)
 
 void RecordsArea::rebuildRecords()
 {
+    TRACE_SPAN("RecordsArea::rebuildRecords");
+
     m_recordList.clearRecords();
 
     auto recordSet = m_root.currentPage().recordsByDate(m_root.currentDate());
@@ -107,6 +110,10 @@ void RecordsArea::recordAdded(widgets::RecordEdit* recEdit)
 void RecordsArea::tagAdded(widgets::TagLabel* label)
 {
     connect(label, &widgets::TagLabel::editingFinished, this, &RecordsArea::tagEdited);
+
+    connect(label, &widgets::TagLabel::completionRequested, this, [=](QString prefix) {
+        label->setCompletions(m_root.tags().completeTagName(prefix, MaxCompletions));
+    });
 }
 
 void RecordsArea::tagEdited(QString oldText, QString newText)
@@ -146,18 +153,15 @@ void RecordsArea::bindRecord(widgets::RecordEdit* recEdit, models::RecordPtr rec
         [=] { tagsFromModel(recEdit, record); });
 
     connect(recEdit, &widgets::RecordEdit::completeChanged, record.get(), [=] {
-        record->setComplete(recEdit->complete());
-        m_storage.saveRecord(record);
+        saveChange(record, [=] { record->setComplete(recEdit->complete()); });
     });
 
     connect(recEdit, &widgets::RecordEdit::titleEditingFinished, record.get(), [=] {
-        record->setTitle(recEdit->title());
-        m_storage.saveRecord(record);
+        saveChange(record, [=] { record->setTitle(recEdit->title()); });
     });
 
     connect(recEdit, &widgets::RecordEdit::descriptionEditingFinished, record.get(), [=] {
-        record->setDescription(recEdit->description());
-        m_storage.saveRecord(record);
+        saveChange(record, [=] { record->setDescription(recEdit->description()); });
     });
 
     connect(recEdit, &widgets::RecordEdit::tagAdded, this, &RecordsArea::tagAdded);
@@ -171,10 +175,18 @@ void RecordsArea::bindRecord(widgets::RecordEdit* recEdit, models::RecordPtr rec
     connect(recEdit, &widgets::RecordEdit::removing, record.get(),
         [=] { removeRecord(record); });
 
+    // scheme drops cached formats before this, so they are rebuilt once
+    auto applyColors = [=](QHash<QString, QColor> colors) {
+        auto& colorScheme = m_root.colorScheme();
+
+        recEdit->setColors(colors);
+        recEdit->setTextFormats(colorScheme.textFormats(recEdit->descriptionFontSize()));
+    };
+
     connect(&m_root.colorScheme(), &models::ColorScheme::widgetColorsChanged, recEdit,
-        &widgets::RecordEdit::setColors);
+        applyColors);
 
-    recEdit->setColors(m_root.colorScheme().widgetColors());
+    applyColors(m_root.colorScheme().widgetColors());
 }
 
 void RecordsArea::bindTag(widgets::TagLabel* label, models::TagPtr tag)
@@ -224,16 +236,29 @@ void RecordsArea::tagsToModel(widgets::RecordEdit* recEdit, models::RecordPtr re
         tagList.append(tag);
     }
 
-    record->setTags(tagList);
+    saveChange(record, [&] { record->setTags(tagList); });
+}
 
-    m_storage.saveRecord(record);
+// first save of new record is logged as its creation
+void RecordsArea::saveChange(
+    models::RecordPtr record, const std::function<void()>& change)
+{
+    const models::RecordState before(*record);
+
+    change();
+
+    if (m_storage.saveRecord(record)) {
+        m_root.operations().addChange(before, models::RecordState(*record));
+    }
 }
 
 void RecordsArea::removeRecord(models::RecordPtr record)
 {
     unsubscribeRecords();
 
-    m_storage.removeRecord(record);
+    if (m_storage.removeRecord(record)) {
+        m_root.operations().addRemove(models::RecordState(*record));
+    }
 
     m_root.currentPage().removeRecord(record);
 
@@ -19,6 +19,8 @@
 #include <QVBoxLayout>
 #include <QWidget>
 
+#include <functional>
+
 namespace tagberry::presenters {
 
 class RecordsArea : public QWidget {
@@ -39,6 +41,8 @@ private slots:
     void tagEdited(QString oldText, QString newText);
 
 private:
+    enum { MaxCompletions = 10 };
+
     void resubscribeRecords();
     void unsubscribeRecords();
 
@@ -48,6 +52,7 @@ private:
     void tagsFromModel(widgets::RecordEdit* cell, models::RecordPtr record);
     void tagsToModel(widgets::RecordEdit* cell, models::RecordPtr record);
 
+    void saveChange(models::RecordPtr record, const std::function<void()>& change);
     void removeRecord(models::RecordPtr);
 
     QVBoxLayout m_layout;
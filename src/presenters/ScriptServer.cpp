@@ -0,0 +1,441 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "presenters/ScriptServer.hpp"
+#include "trace/Trace.hpp"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSet>
+
+#include <utility>
+
+namespace tagberry::presenters {
+
+namespace {
+
+// client not sending newline is dropped instead of growing buffer forever
+const qint64 MaxLineSize = 1 << 20;
+
+QJsonObject errorReply(const QString& error)
+{
+    return QJsonObject { { "ok", false }, { "error", error } };
+}
+
+bool parseDate(const QJsonValue& value, QDate& date)
+{
+    const auto str = value.toString();
+
+    if (str.isEmpty()) {
+        date = QDate();
+        return value.isUndefined() || value.isNull() || value.isString();
+    }
+
+    date = QDate::fromString(str, Qt::ISODate);
+
+    return date.isValid();
+}
+
+} // namespace
+
+ScriptServer::ScriptServer(storage::LocalStorage& storage, models::Root& root)
+    : m_storage(storage)
+    , m_root(root)
+{
+    m_server.setSocketOptions(QLocalServer::UserAccessOption);
+
+    m_batchTimer.setSingleShot(true);
+    m_batchTimer.setInterval(0);
+
+    connect(&m_server, &QLocalServer::newConnection, this, &ScriptServer::acceptClients);
+
+    connect(&m_batchTimer, &QTimer::timeout, this, &ScriptServer::processRequests);
+}
+
+bool ScriptServer::listen(const QString& name)
+{
+    if (m_server.listen(name)) {
+        qDebug() << "listening for scripts on" << m_server.fullServerName();
+        return true;
+    }
+
+    // socket file may be left by crashed instance; live one would answer
+    if (m_server.serverError() == QAbstractSocket::AddressInUseError) {
+        QLocalSocket probe;
+        probe.connectToServer(name);
+
+        if (!probe.waitForConnected(100)) {
+            QLocalServer::removeServer(name);
+
+            if (m_server.listen(name)) {
+                qDebug() << "listening for scripts on" << m_server.fullServerName();
+                return true;
+            }
+        }
+    }
+
+    qWarning() << "can't listen for scripts on" << name << ":" << m_server.errorString();
+    return false;
+}
+
+void ScriptServer::acceptClients()
+{
+    while (auto client = m_server.nextPendingConnection()) {
+        connect(client, &QLocalSocket::readyRead, this, [=] { readClient(client); });
+
+        connect(client, &QLocalSocket::disconnected, client, &QObject::deleteLater);
+    }
+}
+
+void ScriptServer::readClient(QLocalSocket* client)
+{
+    while (client->canReadLine()) {
+        const auto line = client->readLine().trimmed();
+
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        QJsonParseError error;
+        const auto doc = QJsonDocument::fromJson(line, &error);
+
+        QJsonObject json;
+
+        if (doc.isObject()) {
+            json = doc.object();
+        } else {
+            // answered in order with other requests
+            json = QJsonObject { { "op", "invalid" } };
+        }
+
+        m_requests.append({ client, json });
+    }
+
+    if (client->bytesAvailable() > MaxLineSize) {
+        qWarning() << "dropping script client sending too long line";
+        client->abort();
+        return;
+    }
+
+    if (!m_requests.isEmpty()) {
+        m_batchTimer.start();
+    }
+}
+
+void ScriptServer::processRequests()
+{
+    TRACE_SPAN("ScriptServer::processRequests");
+
+    auto requests = std::move(m_requests);
+    m_requests.clear();
+
+    QList<Reply> replies;
+
+    m_root.operations().beginGroup();
+
+    for (const auto& request : requests) {
+        const auto op = request.json.value("op").toString();
+
+        if (op == "add" || op == "update") {
+            QString error;
+
+            if (auto record = makeRecord(request.json, error)) {
+                replies.append({ request.client, {}, record });
+            } else {
+                replies.append({ request.client, errorReply(error), {} });
+            }
+        } else if (op == "query") {
+            // sees writes of requests sent before it
+            saveBatch(replies);
+
+            replies.append({ request.client, runQuery(request.json), {} });
+        } else if (op == "days" || op == "count") {
+            saveBatch(replies);
+
+            replies.append({ request.client, runTagQuery(request.json), {} });
+        } else if (op == "invalid") {
+            replies.append({ request.client, errorReply("can't parse request"), {} });
+        } else {
+            replies.append({ request.client, errorReply("unknown op: " + op), {} });
+        }
+    }
+
+    saveBatch(replies);
+
+    m_root.operations().endGroup();
+
+    for (const auto& reply : replies) {
+        if (reply.client) {
+            reply.client->write(
+                QJsonDocument(reply.json).toJson(QJsonDocument::Compact) + '\n');
+        }
+    }
+
+    if (!m_changedIDs.isEmpty()) {
+        recordsChanged(m_changedIDs, {});
+        m_changedIDs.clear();
+    }
+}
+
+models::RecordPtr ScriptServer::makeRecord(const QJsonObject& request, QString& error)
+{
+    models::RecordPtr record;
+
+    if (request.value("op").toString() == "add") {
+        record = std::make_shared<models::Record>();
+    } else {
+        const auto id = quint32(request.value("id").toDouble());
+
+        if (!id) {
+            error = "missing record id";
+            return {};
+        }
+
+        record = m_batchRecords.value(id);
+
+        if (!record) {
+            record = m_storage.readRecord(id, m_root.tags());
+
+            if (record) {
+                m_batchStates.insert(id, models::RecordState(*record));
+            }
+        }
+
+        if (!record) {
+            error = QString("no record %1").arg(id);
+            return {};
+        }
+
+        m_batchRecords.insert(id, record);
+    }
+
+    if (!applyFields(request, record, error)) {
+        return {};
+    }
+
+    return record;
+}
+
+bool ScriptServer::applyFields(
+    const QJsonObject& request, models::RecordPtr record, QString& error)
+{
+    if (request.contains("date")) {
+        QDate date;
+
+        if (!parseDate(request.value("date"), date)) {
+            error = "date must be YYYY-MM-DD";
+            return false;
+        }
+
+        record->setDate(date);
+    }
+
+    if (request.contains("complete")) {
+        record->setComplete(request.value("complete").toBool());
+    }
+
+    if (request.contains("title")) {
+        record->setTitle(request.value("title").toString());
+    }
+
+    if (request.contains("description")) {
+        record->setDescription(request.value("description").toString());
+    }
+
+    if (request.contains("tags")) {
+        QList<models::TagPtr> tags;
+
+        for (const auto& value : request.value("tags").toArray()) {
+            const auto name = value.toString().trimmed();
+
+            if (name.isEmpty()) {
+                continue;
+            }
+
+            auto tag = m_root.tags().getTagByName(name);
+            if (!tag) {
+                tag = m_root.tags().createTag();
+                tag->setName(name);
+            }
+
+            if (!tags.contains(tag)) {
+                tags.append(tag);
+            }
+        }
+
+        record->setTags(tags);
+    }
+
+    return true;
+}
+
+QJsonObject ScriptServer::runQuery(const QJsonObject& request)
+{
+    storage::RecordFilter filter;
+
+    for (const auto& value : request.value("tags").toArray()) {
+        filter.tags.append(value.toString());
+    }
+
+    if (!parseDate(request.value("from"), filter.from)
+        || !parseDate(request.value("to"), filter.to)) {
+        return errorReply("date must be YYYY-MM-DD");
+    }
+
+    const auto state = request.value("state").toString("all");
+
+    if (state == "open") {
+        filter.state = storage::RecordFilter::State::Open;
+    } else if (state == "complete") {
+        filter.state = storage::RecordFilter::State::Complete;
+    } else if (state != "all") {
+        return errorReply("unknown state: " + state);
+    }
+
+    QJsonArray records;
+
+    const bool ok = m_storage.findRecords(filter, [&](const auto& row) {
+        records.append(QJsonObject {
+            { "id", double(row.id) },
+            { "date", row.date.toString(Qt::ISODate) },
+            { "complete", row.complete },
+            { "title", row.title },
+            { "tags", QJsonArray::fromStringList(row.tags) },
+        });
+    });
+
+    if (!ok) {
+        return errorReply("can't query records");
+    }
+
+    return QJsonObject { { "ok", true }, { "records", records } };
+}
+
+// answered from tag index, which is built on first such request
+QJsonObject ScriptServer::runTagQuery(const QJsonObject& request)
+{
+    if (!m_storage.readTagIndex(m_root.tagIndex())) {
+        return errorReply("can't read tag index");
+    }
+
+    QList<quint32> withTags;
+    QList<quint32> withoutTags;
+
+    // nothing has unknown tag, and nothing is excluded by it
+    bool unknownTag = false;
+
+    for (const auto& value : request.value("tags").toArray()) {
+        const auto tag = m_root.tags().getTagByName(value.toString().trimmed());
+
+        if (tag && tag->hasID()) {
+            withTags.append(tag->id());
+        } else {
+            unknownTag = true;
+        }
+    }
+
+    for (const auto& value : request.value("without").toArray()) {
+        const auto tag = m_root.tags().getTagByName(value.toString().trimmed());
+
+        if (tag && tag->hasID()) {
+            withoutTags.append(tag->id());
+        }
+    }
+
+    const auto& index = m_root.tagIndex();
+
+    if (request.value("op").toString() == "count") {
+        const auto state = request.value("state").toString("all");
+
+        if (state != "open" && state != "complete" && state != "all") {
+            return errorReply("unknown state: " + state);
+        }
+
+        quint64 count = 0;
+
+        if (!unknownTag) {
+            count = index.countRecords(withTags, withoutTags, state == "open");
+
+            if (state == "complete") {
+                count -= index.countRecords(withTags, withoutTags, true);
+            }
+        }
+
+        return QJsonObject { { "ok", true }, { "count", double(count) } };
+    }
+
+    QDate from;
+    QDate to;
+
+    if (!parseDate(request.value("from"), from) || !parseDate(request.value("to"), to)) {
+        return errorReply("date must be YYYY-MM-DD");
+    }
+
+    QJsonArray days;
+
+    if (!unknownTag) {
+        for (const auto& date : index.findDates(withTags, withoutTags, from, to)) {
+            days.append(date.toString(Qt::ISODate));
+        }
+    }
+
+    return QJsonObject { { "ok", true }, { "days", days } };
+}
+
+// saves records of replies not answered yet, through same path as editors
+void ScriptServer::saveBatch(QList<Reply>& replies)
+{
+    QList<models::RecordPtr> records;
+    QSet<const models::Record*> seen;
+
+    for (const auto& reply : replies) {
+        if (reply.record && reply.json.isEmpty() && !seen.contains(reply.record.get())) {
+            seen.insert(reply.record.get());
+            records.append(reply.record);
+        }
+    }
+
+    if (records.isEmpty()) {
+        return;
+    }
+
+    const bool ok = m_storage.saveRecords(records);
+
+    if (ok) {
+        // added records have no state before batch and are logged as created
+        for (const auto& record : std::as_const(records)) {
+            m_root.operations().addChange(
+                m_batchStates.value(record->id()), models::RecordState(*record));
+        }
+    }
+
+    for (auto& reply : replies) {
+        if (!reply.record || !reply.json.isEmpty()) {
+            continue;
+        }
+
+        if (ok) {
+            const auto id = reply.record->id();
+
+            reply.json = QJsonObject { { "ok", true }, { "id", double(id) } };
+
+            if (!m_changedIDs.contains(id)) {
+                m_changedIDs.append(id);
+            }
+        } else {
+            reply.json = errorReply("can't save records");
+        }
+    }
+
+    m_batchRecords.clear();
+    m_batchStates.clear();
+}
+
+} // namespace tagberry::presenters
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "models/Root.hpp"
+#include "storage/LocalStorage.hpp"
+
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+namespace tagberry::presenters {
+
+// Endpoint for scripts talking to running app, which holds DB lock.
+// Each line sent to local socket is a JSON request, answered by one
+// JSON line, in order:
+//
+//   {"op": "add", "date": "2021-03-04", "title": "...", "tags": ["a"]}
+//   {"op": "update", "id": 42, "complete": true}
+//   {"op": "query", "tags": ["a"], "from": "...", "to": "...", "state": "open"}
+//   {"op": "days", "tags": ["a"], "without": ["b"], "from": "...", "to": "..."}
+//   {"op": "count", "tags": ["a"], "without": ["b"], "state": "open"}
+//
+// Requests received in one event loop iteration are saved in a single
+// transaction and undone as a whole, and changed records are reported to
+// update calendar.
+class ScriptServer : public QObject {
+    Q_OBJECT
+
+public:
+    ScriptServer(storage::LocalStorage& storage, models::Root& root);
+
+    bool listen(const QString& name);
+
+signals:
+    void recordsChanged(QList<quint32> changedIDs, QList<quint32> removedIDs);
+
+private slots:
+    void acceptClients();
+    void processRequests();
+
+private:
+    struct Request {
+        QPointer<QLocalSocket> client;
+        QJsonObject json;
+    };
+
+    struct Reply {
+        QPointer<QLocalSocket> client;
+        QJsonObject json;
+        // written by batch, answered with its id once batch is saved
+        models::RecordPtr record;
+    };
+
+    void readClient(QLocalSocket* client);
+
+    models::RecordPtr makeRecord(const QJsonObject& request, QString& error);
+    bool applyFields(
+        const QJsonObject& request, models::RecordPtr record, QString& error);
+
+    QJsonObject runQuery(const QJsonObject& request);
+    QJsonObject runTagQuery(const QJsonObject& request);
+
+    void saveBatch(QList<Reply>& replies);
+
+    storage::LocalStorage& m_storage;
+    models::Root& m_root;
+
+    QLocalServer m_server;
+    QTimer m_batchTimer;
+
+    QList<Request> m_requests;
+
+    // records of current batch, so that repeated updates are merged,
+    // and their states before batch, for undo
+    QHash<quint32, models::RecordPtr> m_batchRecords;
+    QHash<quint32, models::RecordState> m_batchStates;
+    QList<quint32> m_changedIDs;
+};
+
+} // namespace tagberry::presenters
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "presenters/SearchArea.hpp"
+
+namespace tagberry::presenters {
+
+SearchArea::SearchArea(storage::LocalStorage& storage, models::Root& root)
+    : m_storage(storage)
+    , m_root(root)
+{
+    m_layout.setContentsMargins(QMargins(0, 0, 0, 0));
+    m_layout.addWidget(&m_searchBox);
+
+    setLayout(&m_layout);
+
+    m_typingTimer.setSingleShot(true);
+    m_typingTimer.setInterval(TypingDelay);
+
+    connect(&m_typingTimer, &QTimer::timeout, this, &SearchArea::fetchResults);
+
+    connect(&m_searchBox, &widgets::SearchBox::queryChanged, this,
+        &SearchArea::startSearch);
+
+    // queued, so that list is not extended while results are added
+    connect(&m_searchBox, &widgets::SearchBox::moreResultsWanted, this,
+        &SearchArea::fetchMoreResults, Qt::QueuedConnection);
+
+    // results are cleared while activating, so don't do it from list signal
+    connect(&m_searchBox, &widgets::SearchBox::resultActivated, this,
+        &SearchArea::activateResult, Qt::QueuedConnection);
+
+    connect(&m_root.colorScheme(), &models::ColorScheme::widgetColorsChanged,
+        &m_searchBox, &widgets::SearchBox::setColors);
+
+    m_searchBox.setColors(m_root.colorScheme().widgetColors());
+}
+
+bool SearchArea::isActive() const
+{
+    return !m_query.isEmpty();
+}
+
+void SearchArea::startSearch(QString text)
+{
+    const bool wasActive = isActive();
+
+    m_query = text.trimmed();
+
+    m_typingTimer.stop();
+    m_searchBox.clearResults();
+    m_resultDates.clear();
+    m_lastHit = storage::SearchHit();
+    m_hasMore = false;
+
+    if (isActive()) {
+        m_typingTimer.start();
+    }
+
+    if (wasActive != isActive()) {
+        activeChanged(isActive());
+    }
+}
+
+void SearchArea::fetchResults()
+{
+    QList<storage::SearchHit> hits;
+
+    m_hasMore = false;
+
+    if (!m_storage.searchRecords(m_query, m_lastHit, PageSize, hits)) {
+        return;
+    }
+
+    if (hits.isEmpty()) {
+        return;
+    }
+
+    for (const auto& hit : hits) {
+        m_searchBox.addResult(hit.date, hit.title, hit.snippet, hit.complete);
+        m_resultDates.append(hit.date);
+    }
+
+    m_lastHit = hits.last();
+    m_hasMore = hits.size() == PageSize && m_resultDates.size() < MaxResults;
+}
+
+// requests are queued and may be stale, so scroll position is checked again
+void SearchArea::fetchMoreResults()
+{
+    if (m_hasMore && !m_typingTimer.isActive() && m_searchBox.isScrolledToEnd()) {
+        fetchResults();
+    }
+}
+
+void SearchArea::activateResult(int index)
+{
+    if (index < 0 || index >= m_resultDates.size()) {
+        return;
+    }
+
+    auto date = m_resultDates[index];
+
+    // records without date are not shown on calendar
+    if (!date.isValid()) {
+        return;
+    }
+
+    m_searchBox.clearQuery();
+
+    dateActivated(date);
+}
+
+} // namespace tagberry::presenters
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "models/Root.hpp"
+#include "storage/LocalStorage.hpp"
+#include "widgets/SearchBox.hpp"
+
+#include <QDate>
+#include <QTimer>
+#include <QVBoxLayout>
+#include <QWidget>
+
+namespace tagberry::presenters {
+
+class SearchArea : public QWidget {
+    Q_OBJECT
+
+public:
+    SearchArea(storage::LocalStorage& storage, models::Root& root);
+
+    bool isActive() const;
+
+signals:
+    void activeChanged(bool);
+    void dateActivated(QDate);
+
+private slots:
+    void startSearch(QString);
+    void fetchResults();
+    void fetchMoreResults();
+    void activateResult(int);
+
+private:
+    // first page is fetched when typing pauses, next ones when list is
+    // scrolled to its end
+    enum { PageSize = 50, MaxResults = 1000, TypingDelay = 150 };
+
+    QVBoxLayout m_layout;
+    widgets::SearchBox m_searchBox;
+
+    QTimer m_typingTimer;
+    QString m_query;
+    QList<QDate> m_resultDates;
+
+    // last fetched hit, next page starts after it
+    storage::SearchHit m_lastHit;
+    bool m_hasMore {};
+
+    storage::LocalStorage& m_storage;
+    models::Root& m_root;
+};
+
+} // namespace tagberry::presenters
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "presenters/TagStatsArea.hpp"
+
+namespace tagberry::presenters {
+
+TagStatsArea::TagStatsArea(storage::LocalStorage& storage, models::Root& root)
+    : m_storage(storage)
+    , m_root(root)
+{
+    m_layout.setContentsMargins(QMargins(0, 0, 0, 0));
+    m_layout.addWidget(&m_statsView);
+
+    setLayout(&m_layout);
+
+    connect(&m_storage, &storage::LocalStorage::tagStatsChanged, this,
+        &TagStatsArea::refreshTag);
+
+    connect(&m_statsView, &widgets::TagStatsView::tagActivated, this,
+        &TagStatsArea::activateTag);
+}
+
+// table is filled only while visible, tags could be renamed meanwhile
+void TagStatsArea::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    refreshAll();
+}
+
+void TagStatsArea::refreshAll()
+{
+    QList<storage::TagStats> stats;
+
+    if (!m_storage.readTagStats(stats)) {
+        return;
+    }
+
+    m_statsView.beginUpdate();
+    m_statsView.clearStats();
+
+    for (const auto& tag : stats) {
+        m_statsView.setTagStats(tag.tagID, tag.name, tag.total, tag.open, tag.lastUsed);
+    }
+
+    m_statsView.endUpdate();
+}
+
+void TagStatsArea::refreshTag(quint32 tagID)
+{
+    if (!isVisible()) {
+        return;
+    }
+
+    storage::TagStats tag;
+
+    if (!m_storage.readTagStats(tagID, tag)) {
+        return;
+    }
+
+    m_statsView.setTagStats(tag.tagID, tag.name, tag.total, tag.open, tag.lastUsed);
+}
+
+void TagStatsArea::activateTag(quint32 tagID)
+{
+    if (auto tag = m_root.tags().getTagByID(tagID)) {
+        m_root.tags().focusTag(tag);
+    }
+}
+
+} // namespace tagberry::presenters
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "models/Root.hpp"
+#include "storage/LocalStorage.hpp"
+#include "widgets/TagStatsView.hpp"
+
+#include <QVBoxLayout>
+#include <QWidget>
+
+namespace tagberry::presenters {
+
+class TagStatsArea : public QWidget {
+    Q_OBJECT
+
+public:
+    TagStatsArea(storage::LocalStorage& storage, models::Root& root);
+
+protected:
+    void showEvent(QShowEvent* event) override;
+
+private slots:
+    void refreshTag(quint32 tagID);
+    void activateTag(quint32 tagID);
+
+private:
+    void refreshAll();
+
+    QVBoxLayout m_layout;
+    widgets::TagStatsView m_statsView;
+
+    storage::LocalStorage& m_storage;
+    models::Root& m_root;
+};
+
+} // namespace tagberry::presenters
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "presenters/UndoHistory.hpp"
+#include "trace/Trace.hpp"
+
+#include <QDebug>
+#include <QHash>
+#include <QSet>
+
+#include <utility>
+
+namespace tagberry::presenters {
+
+namespace {
+
+QVector<quint32> tagIDs(const models::Record& record)
+{
+    QVector<quint32> ids;
+    for (const auto& tag : record.tags()) {
+        ids.append(tag->id());
+    }
+    return ids;
+}
+
+} // namespace
+
+UndoHistory::UndoHistory(storage::LocalStorage& storage, models::Root& root)
+    : m_storage(storage)
+    , m_root(root)
+{
+}
+
+void UndoHistory::undo()
+{
+    auto& log = m_root.operations();
+
+    if (!log.canUndo()) {
+        return;
+    }
+
+    if (!apply(log.undoGroup())) {
+        qWarning() << "can't undo, history is dropped";
+        log.clear();
+    }
+}
+
+void UndoHistory::redo()
+{
+    auto& log = m_root.operations();
+
+    if (!log.canRedo()) {
+        return;
+    }
+
+    if (!apply(log.redoGroup())) {
+        qWarning() << "can't redo, history is dropped";
+        log.clear();
+    }
+}
+
+bool UndoHistory::apply(const std::vector<models::Operation*>& ops)
+{
+    TRACE_SPAN("UndoHistory::apply");
+
+    using Kind = models::Operation::Kind;
+
+    // by ids known to log, which are old ids for restored records
+    QHash<quint32, models::RecordPtr> records;
+    QSet<quint32> restored;
+    QSet<quint32> removedIDs;
+    QList<models::RecordPtr> removed;
+
+    auto recordOf = [&](quint32 id) {
+        auto record = records.value(id);
+
+        if (!record && !removedIDs.contains(id)) {
+            record = m_storage.readRecord(id, m_root.tags());
+            if (record) {
+                records.insert(id, record);
+            }
+        }
+
+        if (!record) {
+            qWarning() << "record" << id << "is gone";
+        }
+
+        return record;
+    };
+
+    for (auto op : ops) {
+        if (op->kind == Kind::RestoreRecord) {
+            records.insert(op->recordID, std::make_shared<models::Record>());
+            restored.insert(op->recordID);
+            removedIDs.remove(op->recordID);
+
+            op->kind = Kind::RemoveRecord;
+            continue;
+        }
+
+        auto record = recordOf(op->recordID);
+        if (!record) {
+            return false;
+        }
+
+        switch (op->kind) {
+        case Kind::Title: {
+            auto title = record->title();
+            record->setTitle(op->text);
+            op->text = title;
+        } break;
+
+        case Kind::Description: {
+            auto description = record->description();
+            record->setDescription(op->text);
+            op->text = description;
+        } break;
+
+        case Kind::Complete: {
+            const bool complete = record->complete();
+            record->setComplete(op->value != 0);
+            op->value = complete ? 1 : 0;
+        } break;
+
+        case Kind::Date: {
+            const auto date = record->date();
+            record->setDate(op->value ? QDate::fromJulianDay(op->value) : QDate());
+            op->value = date.isValid() ? qint32(date.toJulianDay()) : 0;
+        } break;
+
+        case Kind::Tags: {
+            QList<models::TagPtr> tags;
+            for (auto id : op->tagIDs) {
+                if (auto tag = m_root.tags().getTagByID(id)) {
+                    tags.append(tag);
+                }
+            }
+            op->tagIDs = tagIDs(*record);
+            record->setTags(tags);
+        } break;
+
+        case Kind::RemoveRecord:
+            records.remove(op->recordID);
+            removedIDs.insert(op->recordID);
+
+            // restored earlier in same group is just not saved
+            if (record->hasID()) {
+                removed.append(record);
+            }
+
+            op->kind = Kind::RestoreRecord;
+            break;
+
+        case Kind::RestoreRecord:
+            break;
+        }
+    }
+
+    if (!m_storage.saveRecords(records.values(), removed)) {
+        return false;
+    }
+
+    QList<quint32> changedIDs;
+
+    for (auto it = records.constBegin(); it != records.constEnd(); ++it) {
+        const auto id = it.value()->id();
+
+        // ids are never reused by records table, so this is unambiguous
+        if (restored.contains(it.key()) && id != it.key()) {
+            m_root.operations().remapRecord(it.key(), id);
+        }
+
+        changedIDs.append(id);
+    }
+
+    QList<quint32> gone;
+
+    for (const auto& record : std::as_const(removed)) {
+        gone.append(record->id());
+    }
+
+    recordsChanged(changedIDs, gone);
+
+    return true;
+}
+
+} // namespace tagberry::presenters
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "models/OperationLog.hpp"
+#include "models/Root.hpp"
+#include "storage/LocalStorage.hpp"
+
+#include <QList>
+#include <QObject>
+
+#include <vector>
+
+namespace tagberry::presenters {
+
+// Applies groups of logged operations to storage, each group in one
+// transaction, and reports changed records like script requests do.
+class UndoHistory : public QObject {
+    Q_OBJECT
+
+public:
+    UndoHistory(storage::LocalStorage& storage, models::Root& root);
+
+public slots:
+    void undo();
+    void redo();
+
+signals:
+    void recordsChanged(QList<quint32> changedIDs, QList<quint32> removedIDs);
+
+private:
+    bool apply(const std::vector<models::Operation*>& ops);
+
+    storage::LocalStorage& m_storage;
+    models::Root& m_root;
+};
+
+} // namespace tagberry::presenters
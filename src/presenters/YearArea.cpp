@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "presenters/YearArea.hpp"
+
+namespace tagberry::presenters {
+
+YearArea::YearArea(storage::LocalStorage& storage, models::Root& root)
+    : m_storage(storage)
+    , m_root(root)
+{
+    m_prevYear.setIcon(QIcon(":/icons/arrow-left.png"));
+    m_nextYear.setIcon(QIcon(":/icons/arrow-right.png"));
+
+    m_prevYear.setIconSize(QSize(16, 16));
+    m_nextYear.setIconSize(QSize(16, 16));
+
+    m_prevYear.setFixedWidth(35);
+    m_nextYear.setFixedWidth(35);
+
+    m_yearLabel.setAlignment(Qt::AlignCenter);
+    m_yearLabel.setMinimumWidth(50);
+
+    m_tagFilter.setPlaceholderText("tag");
+    m_tagFilter.setClearButtonEnabled(true);
+    m_tagFilter.setFixedWidth(150);
+
+    m_headerLayout.setContentsMargins(QMargins(0, 0, 0, 0));
+    m_headerLayout.addWidget(&m_prevYear);
+    m_headerLayout.addWidget(&m_yearLabel);
+    m_headerLayout.addWidget(&m_nextYear);
+    m_headerLayout.addStretch(1);
+    m_headerLayout.addWidget(&m_tagFilter);
+
+    m_layout.addLayout(&m_headerLayout);
+    m_layout.addWidget(&m_yearView, 1);
+
+    setLayout(&m_layout);
+
+    connect(&m_prevYear, &QPushButton::clicked, this, &YearArea::prevYear);
+    connect(&m_nextYear, &QPushButton::clicked, this, &YearArea::nextYear);
+
+    connect(&m_tagFilter, &QLineEdit::editingFinished, this, &YearArea::changeTagFilter);
+
+    connect(&m_yearView, &widgets::YearView::dateClicked, this, &YearArea::dateActivated);
+
+    connect(&m_storage, &storage::LocalStorage::dayStatsChanged, this,
+        &YearArea::refreshDay);
+
+    connect(&m_root.colorScheme(), &models::ColorScheme::widgetColorsChanged,
+        &m_yearView, &widgets::YearView::setColors);
+
+    m_yearView.setColors(m_root.colorScheme().widgetColors());
+
+    refreshYear();
+}
+
+void YearArea::prevYear()
+{
+    m_yearView.setYear(m_yearView.year() - 1);
+    refreshYear();
+}
+
+void YearArea::nextYear()
+{
+    m_yearView.setYear(m_yearView.year() + 1);
+    refreshYear();
+}
+
+void YearArea::changeTagFilter()
+{
+    quint32 tagID = 0;
+
+    auto name = m_tagFilter.text().trimmed();
+    if (!name.isEmpty()) {
+        if (auto tag = m_root.tags().getTagByName(name)) {
+            tagID = tag->id();
+        }
+    }
+
+    // unknown tag shows empty year instead of all records
+    const bool unknownTag = !name.isEmpty() && !tagID;
+
+    if (tagID == m_tagID && unknownTag == m_unknownTag) {
+        return;
+    }
+
+    m_tagID = tagID;
+    m_unknownTag = unknownTag;
+
+    refreshYear();
+}
+
+void YearArea::refreshYear()
+{
+    const int year = m_yearView.year();
+
+    m_yearLabel.setText(QString::number(year));
+    m_yearView.clearStats();
+
+    if (m_unknownTag) {
+        return;
+    }
+
+    QList<storage::DayStats> stats;
+
+    if (!m_storage.readDayStats(QDate(year, 1, 1), QDate(year, 12, 31), m_tagID, stats)) {
+        return;
+    }
+
+    m_yearView.beginUpdate();
+
+    for (const auto& day : stats) {
+        m_yearView.setDayStats(day.date, day.total, day.complete);
+    }
+
+    m_yearView.endUpdate();
+}
+
+void YearArea::refreshDay(QDate date)
+{
+    if (date.year() != m_yearView.year() || m_unknownTag) {
+        return;
+    }
+
+    QList<storage::DayStats> stats;
+
+    if (!m_storage.readDayStats(date, date, m_tagID, stats)) {
+        return;
+    }
+
+    if (stats.isEmpty()) {
+        m_yearView.setDayStats(date, 0, 0);
+    } else {
+        m_yearView.setDayStats(date, stats[0].total, stats[0].complete);
+    }
+}
+
+} // namespace tagberry::presenters
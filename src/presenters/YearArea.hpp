@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "models/Root.hpp"
+#include "storage/LocalStorage.hpp"
+#include "widgets/YearView.hpp"
+
+#include <QDate>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <QWidget>
+
+namespace tagberry::presenters {
+
+class YearArea : public QWidget {
+    Q_OBJECT
+
+public:
+    YearArea(storage::LocalStorage& storage, models::Root& root);
+
+signals:
+    void dateActivated(QDate);
+
+private slots:
+    void prevYear();
+    void nextYear();
+    void changeTagFilter();
+
+    void refreshYear();
+    void refreshDay(QDate);
+
+private:
+    QVBoxLayout m_layout;
+    QHBoxLayout m_headerLayout;
+
+    QPushButton m_prevYear;
+    QLabel m_yearLabel;
+    QPushButton m_nextYear;
+    QLineEdit m_tagFilter;
+
+    widgets::YearView m_yearView;
+
+    // zero if all records are shown
+    quint32 m_tagID {};
+    bool m_unknownTag {};
+
+    storage::LocalStorage& m_storage;
+    models::Root& m_root;
+};
+
+} // namespace tagberry::presenters
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/BulkWriter.hpp"
+
+#include <QDebug>
+#include <QSqlDatabase>
+
+#include <algorithm>
+
+namespace tagberry::storage {
+
+void BulkWriter::setDurable(bool durable)
+{
+    m_durable = durable;
+}
+
+bool BulkWriter::begin()
+{
+    if (!m_durable) {
+        QSqlQuery query;
+
+        if (query.exec("PRAGMA synchronous") && query.next()) {
+            m_oldSync = query.value(0).toString();
+        }
+        query.exec("PRAGMA synchronous = OFF");
+    }
+
+    if (!QSqlDatabase::database().transaction()) {
+        qCritical() << "can't start transaction";
+        restoreSync();
+        return false;
+    }
+
+    if (!m_tagQuery.prepare("INSERT INTO tags (name, color) VALUES (:name, :color)")
+        || !m_recordQuery.prepare("INSERT INTO records (date, state, title, description)"
+                                  " VALUES (:date, :state, :title, :description)")
+        || !m_linkQuery.prepare(
+            "INSERT INTO record2tag (record, tag) VALUES (:record, :tag)")) {
+        qCritical() << "can't prepare bulk statements";
+        rollback();
+        return false;
+    }
+
+    return true;
+}
+
+bool BulkWriter::commit()
+{
+    m_tagQuery.finish();
+    m_recordQuery.finish();
+    m_linkQuery.finish();
+
+    if (!writeStats()) {
+        rollback();
+        return false;
+    }
+
+    const bool ok = QSqlDatabase::database().commit();
+    if (!ok) {
+        qCritical() << "can't commit bulk transaction";
+    }
+
+    restoreSync();
+
+    return ok;
+}
+
+void BulkWriter::rollback()
+{
+    m_tagQuery.finish();
+    m_recordQuery.finish();
+    m_linkQuery.finish();
+
+    QSqlDatabase::database().rollback();
+
+    m_dayStats.clear();
+
+    restoreSync();
+}
+
+void BulkWriter::restoreSync()
+{
+    if (!m_oldSync.isEmpty()) {
+        QSqlQuery query;
+        query.exec("PRAGMA synchronous = " + m_oldSync);
+        m_oldSync.clear();
+    }
+}
+
+bool BulkWriter::addTag(const QString& name, quint32& id)
+{
+    const int color = m_colorScheme.tagIndex(name);
+
+    m_tagQuery.bindValue(":name", name);
+    m_tagQuery.bindValue(":color", color >= 0 ? QVariant(color) : QVariant());
+
+    if (!m_tagQuery.exec()) {
+        qCritical() << "can't insert tag";
+        return false;
+    }
+
+    id = m_tagQuery.lastInsertId().toUInt();
+
+    return true;
+}
+
+bool BulkWriter::addRecord(const QDate& date, bool complete, const QString& title,
+    const QString& description, const QVector<quint32>& tagIDs, quint32& id)
+{
+    // same as in LocalStorage, julian day number or NULL
+    m_recordQuery.bindValue(
+        ":date", date.isValid() ? QVariant(date.toJulianDay()) : QVariant());
+    m_recordQuery.bindValue(":state", complete ? 1 : 0);
+    m_recordQuery.bindValue(":title", title);
+    m_recordQuery.bindValue(":description", description);
+
+    if (!m_recordQuery.exec()) {
+        qCritical() << "can't insert record";
+        return false;
+    }
+
+    id = m_recordQuery.lastInsertId().toUInt();
+
+    // records without date are not counted, as in LocalStorage
+    if (date.isValid()) {
+        countRecord(date.toJulianDay(), 0, complete);
+
+        for (auto tagID : tagIDs) {
+            countRecord(date.toJulianDay(), tagID, complete);
+        }
+    }
+
+    for (auto tagID : tagIDs) {
+        m_linkQuery.bindValue(":record", id);
+        m_linkQuery.bindValue(":tag", tagID);
+
+        if (!m_linkQuery.exec()) {
+            qCritical() << "can't insert record2tag";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void BulkWriter::countRecord(qint64 day, quint32 tagID, bool complete)
+{
+    auto& counters = m_dayStats[qMakePair(tagID, day)];
+
+    counters.total++;
+    counters.complete += complete ? 1 : 0;
+}
+
+// one statement per (tag, day) and per tag, instead of per record
+bool BulkWriter::writeStats()
+{
+    struct TagCounters {
+        int total {};
+        int open {};
+        qint64 lastUsed {};
+    };
+
+    QHash<quint32, TagCounters> tagStats;
+
+    QSqlQuery query;
+
+    query.prepare("INSERT INTO day_stats (day, tag, total, complete)"
+                  " VALUES (:day, :tag, :total, :complete)"
+                  " ON CONFLICT (tag, day) DO UPDATE SET"
+                  "  total = total + excluded.total,"
+                  "  complete = complete + excluded.complete");
+
+    for (auto it = m_dayStats.cbegin(); it != m_dayStats.cend(); ++it) {
+        query.bindValue(":day", it.key().second);
+        query.bindValue(":tag", it.key().first);
+        query.bindValue(":total", it->total);
+        query.bindValue(":complete", it->complete);
+
+        if (!query.exec()) {
+            qCritical() << "can't update day_stats";
+            return false;
+        }
+
+        if (it.key().first != 0) {
+            auto& tag = tagStats[it.key().first];
+
+            tag.total += it->total;
+            tag.open += it->total - it->complete;
+            tag.lastUsed = std::max(tag.lastUsed, it.key().second);
+        }
+    }
+
+    query.prepare("INSERT INTO tag_stats (tag, total, open, last_used)"
+                  " VALUES (:tag, :total, :open, :day)"
+                  " ON CONFLICT (tag) DO UPDATE SET"
+                  "  total = total + excluded.total,"
+                  "  open = open + excluded.open,"
+                  "  last_used = MAX(IFNULL(last_used, 0), excluded.last_used)");
+
+    for (auto it = tagStats.cbegin(); it != tagStats.cend(); ++it) {
+        query.bindValue(":tag", it.key());
+        query.bindValue(":total", it->total);
+        query.bindValue(":open", it->open);
+        query.bindValue(":day", it->lastUsed);
+
+        if (!query.exec()) {
+            qCritical() << "can't update tag_stats";
+            return false;
+        }
+    }
+
+    m_dayStats.clear();
+
+    return true;
+}
+
+} // namespace tagberry::storage
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "models/ColorScheme.hpp"
+
+#include <QDate>
+#include <QHash>
+#include <QPair>
+#include <QSqlQuery>
+#include <QString>
+#include <QVector>
+
+namespace tagberry::storage {
+
+// Fast insertion of many rows into opened storage, with statements prepared
+// once and all rows written in one transaction. Derived tables (day_stats,
+// tag_stats) are updated by commit(), from counters collected in memory.
+class BulkWriter {
+public:
+    // non-durable writer turns off fsync until commit, a crash may corrupt
+    // whole database, so only for throwaway databases like generated ones
+    void setDurable(bool durable);
+
+    bool begin();
+    bool commit();
+    void rollback();
+
+    bool addTag(const QString& name, quint32& id);
+
+    bool addRecord(const QDate& date, bool complete, const QString& title,
+        const QString& description, const QVector<quint32>& tagIDs, quint32& id);
+
+private:
+    struct Counters {
+        int total {};
+        int complete {};
+    };
+
+    void countRecord(qint64 day, quint32 tagID, bool complete);
+    bool writeStats();
+    void restoreSync();
+
+    QSqlQuery m_tagQuery;
+    QSqlQuery m_recordQuery;
+    QSqlQuery m_linkQuery;
+
+    // per (tag, day) of added records, tag 0 counts all records
+    QHash<QPair<quint32, qint64>, Counters> m_dayStats;
+
+    bool m_durable {true};
+    QString m_oldSync;
+
+    // same color indexes as tags created in app
+    models::ColorScheme m_colorScheme;
+};
+
+} // namespace tagberry::storage
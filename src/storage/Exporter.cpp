@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/Exporter.hpp"
+#include "trace/Trace.hpp"
+
+#include <QDate>
+#include <QDebug>
+#include <QSqlQuery>
+
+namespace tagberry::storage {
+
+namespace {
+
+// written to device in chunks of this size
+const int bufferSize = 1 << 20;
+
+void appendJson(QByteArray& out, const QString& str)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    out += '"';
+
+    for (char c : str.toUtf8()) {
+        switch (c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            if (uchar(c) < 0x20) {
+                out += "\\u00";
+                out += hex[uchar(c) >> 4];
+                out += hex[uchar(c) & 0xf];
+            } else {
+                out += c;
+            }
+        }
+    }
+
+    out += '"';
+}
+
+// quoted only when needed, as in RFC 4180
+void appendCsv(QByteArray& out, const QString& str)
+{
+    const auto utf8 = str.toUtf8();
+
+    if (!utf8.contains(',') && !utf8.contains('"') && !utf8.contains('\n')
+        && !utf8.contains('\r')) {
+        out += utf8;
+        return;
+    }
+
+    out += '"';
+    for (char c : utf8) {
+        if (c == '"') {
+            out += '"';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+} // namespace
+
+Exporter::Exporter(Format format)
+    : m_format(format)
+{
+}
+
+quint64 Exporter::recordCount() const
+{
+    return m_recordCount;
+}
+
+bool Exporter::write(QIODevice& out)
+{
+    TRACE_SPAN("Exporter::write");
+
+    if (!readTagNames()) {
+        return false;
+    }
+
+    m_buffer.reserve(bufferSize + bufferSize / 4);
+    m_recordCount = 0;
+
+    writeHeader();
+
+    QSqlQuery query;
+    query.setForwardOnly(true);
+
+    // rows of one record come one after another, in rowid order
+    if (!query.exec("SELECT records.id, records.date, records.state, records.title,"
+                    " records.description, record2tag.tag"
+                    " FROM records LEFT JOIN record2tag ON record2tag.record = records.id"
+                    " ORDER BY records.id")) {
+        qCritical() << "can't read records for export";
+        return false;
+    }
+
+    Row row;
+
+    while (query.next()) {
+        const auto id = query.value(0).toUInt();
+
+        if (id != row.id) {
+            if (row.id) {
+                writeRow(row);
+
+                if (!flush(out, false)) {
+                    return false;
+                }
+            }
+
+            row.id = id;
+            row.date = query.isNull(1)
+                ? QString()
+                : QDate::fromJulianDay(query.value(1).toLongLong()).toString(Qt::ISODate);
+            row.complete = query.value(2).toInt() == 1;
+            row.title = query.value(3).toString();
+            row.description = query.value(4).toString();
+            row.tags.clear();
+        }
+
+        if (!query.isNull(5)) {
+            row.tags.append(m_tagNames.value(query.value(5).toUInt()));
+        }
+    }
+
+    if (row.id) {
+        writeRow(row);
+    }
+
+    return flush(out, true);
+}
+
+bool Exporter::readTagNames()
+{
+    m_tagNames.clear();
+
+    QSqlQuery query;
+    query.setForwardOnly(true);
+
+    if (!query.exec("SELECT id, name FROM tags")) {
+        qCritical() << "can't read tags for export";
+        return false;
+    }
+
+    while (query.next()) {
+        m_tagNames.insert(query.value(0).toUInt(), query.value(1).toString());
+    }
+
+    return true;
+}
+
+void Exporter::writeHeader()
+{
+    if (m_format == Format::Csv) {
+        m_buffer += "id,date,complete,title,description,tags\n";
+    }
+}
+
+void Exporter::writeRow(const Row& row)
+{
+    m_recordCount++;
+
+    if (m_format == Format::Csv) {
+        m_buffer += QByteArray::number(row.id);
+        m_buffer += ',';
+        m_buffer += row.date.toLatin1();
+        m_buffer += ',';
+        m_buffer += row.complete ? "1" : "0";
+        m_buffer += ',';
+        appendCsv(m_buffer, row.title);
+        m_buffer += ',';
+        appendCsv(m_buffer, row.description);
+        m_buffer += ',';
+        appendCsv(m_buffer, row.tags.join(';'));
+        m_buffer += '\n';
+        return;
+    }
+
+    m_buffer += "{\"id\":";
+    m_buffer += QByteArray::number(row.id);
+    m_buffer += ",\"date\":";
+    if (row.date.isEmpty()) {
+        m_buffer += "null";
+    } else {
+        appendJson(m_buffer, row.date);
+    }
+    m_buffer += ",\"complete\":";
+    m_buffer += row.complete ? "true" : "false";
+    m_buffer += ",\"title\":";
+    appendJson(m_buffer, row.title);
+    m_buffer += ",\"description\":";
+    appendJson(m_buffer, row.description);
+    m_buffer += ",\"tags\":[";
+    for (int n = 0; n < row.tags.size(); n++) {
+        if (n) {
+            m_buffer += ',';
+        }
+        appendJson(m_buffer, row.tags[n]);
+    }
+    m_buffer += "]}\n";
+}
+
+bool Exporter::flush(QIODevice& out, bool force)
+{
+    if (m_buffer.isEmpty() || (!force && m_buffer.size() < bufferSize)) {
+        return true;
+    }
+
+    if (out.write(m_buffer) != m_buffer.size()) {
+        qCritical() << "can't write export:" << out.errorString();
+        return false;
+    }
+
+    // unlike clear(), keeps reserved capacity
+    m_buffer.resize(0);
+
+    return true;
+}
+
+} // namespace tagberry::storage
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+
+namespace tagberry::storage {
+
+// Streams all records of opened storage with names of their tags, one
+// record per line. Records are walked with forward-only cursor and no
+// models are built, so memory use doesn't depend on db size.
+class Exporter {
+public:
+    enum class Format { Jsonl, Csv };
+
+    explicit Exporter(Format format);
+
+    bool write(QIODevice& out);
+
+    quint64 recordCount() const;
+
+private:
+    struct Row {
+        quint32 id {};
+        QString date;
+        bool complete {};
+        QString title;
+        QString description;
+        QStringList tags;
+    };
+
+    bool readTagNames();
+
+    void writeHeader();
+    void writeRow(const Row& row);
+    bool flush(QIODevice& out, bool force);
+
+    Format m_format;
+    QHash<quint32, QString> m_tagNames;
+
+    QByteArray m_buffer;
+    quint64 m_recordCount {};
+};
+
+} // namespace tagberry::storage
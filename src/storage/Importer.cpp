@@ -0,0 +1,543 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/Importer.hpp"
+#include "storage/BulkWriter.hpp"
+#include "trace/Trace.hpp"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSqlQuery>
+
+#include <memory>
+
+namespace tagberry::storage {
+
+namespace {
+
+// records per transaction
+const int chunkSize = 5000;
+
+struct ImportRecord {
+    QDate date;
+    bool complete {};
+    QString title;
+    QString description;
+    QStringList tags;
+
+    // where next record starts
+    qint64 endOffset {};
+};
+
+class RecordReader {
+public:
+    virtual ~RecordReader() = default;
+
+    // false at end of file
+    virtual bool next(ImportRecord& rec) = 0;
+};
+
+QString readLine(QFile& file)
+{
+    auto line = QString::fromUtf8(file.readLine());
+
+    while (line.endsWith('\n') || line.endsWith('\r')) {
+        line.chop(1);
+    }
+
+    return line;
+}
+
+// columns are found by header: date, complete, title, description, tags
+class CsvReader : public RecordReader {
+public:
+    explicit CsvReader(QFile& file)
+        : m_file(file)
+    {
+    }
+
+    bool readHeader()
+    {
+        QStringList fields;
+        if (!readRow(fields)) {
+            qCritical() << "can't read csv header";
+            return false;
+        }
+
+        m_date = fields.indexOf("date");
+        m_complete = fields.indexOf("complete");
+        m_title = fields.indexOf("title");
+        m_description = fields.indexOf("description");
+        m_tags = fields.indexOf("tags");
+
+        if (m_title < 0) {
+            qCritical() << "csv has no title column";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool next(ImportRecord& rec) override
+    {
+        QStringList fields;
+
+        while (readRow(fields)) {
+            if (fields.size() == 1 && fields[0].isEmpty()) {
+                continue;
+            }
+
+            const auto date = field(fields, m_date).trimmed();
+
+            rec = ImportRecord();
+            rec.date = QDate::fromString(date, Qt::ISODate);
+
+            if (!date.isEmpty() && !rec.date.isValid()) {
+                qWarning() << "skipping record with bad date" << date;
+                continue;
+            }
+
+            const auto complete = field(fields, m_complete).trimmed().toLower();
+
+            rec.complete = complete == "1" || complete == "true" || complete == "x";
+            rec.title = field(fields, m_title);
+            rec.description = field(fields, m_description);
+
+            for (const auto& tag : field(fields, m_tags).split(';')) {
+                if (!tag.trimmed().isEmpty()) {
+                    rec.tags.append(tag.trimmed());
+                }
+            }
+
+            rec.endOffset = m_file.pos();
+
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    // quoted fields may span several lines
+    bool readRow(QStringList& fields)
+    {
+        if (m_file.atEnd()) {
+            return false;
+        }
+
+        auto line = m_file.readLine();
+        while (line.count('"') % 2 && !m_file.atEnd()) {
+            line += m_file.readLine();
+        }
+
+        while (line.endsWith('\n') || line.endsWith('\r')) {
+            line.chop(1);
+        }
+
+        const auto text = QString::fromUtf8(line);
+
+        fields.clear();
+
+        QString value;
+        bool quoted = false;
+
+        for (int n = 0; n < text.size(); n++) {
+            const auto c = text[n];
+
+            if (quoted) {
+                if (c != '"') {
+                    value += c;
+                } else if (n + 1 < text.size() && text[n + 1] == '"') {
+                    value += c;
+                    n++;
+                } else {
+                    quoted = false;
+                }
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == ',') {
+                fields.append(value);
+                value.clear();
+            } else {
+                value += c;
+            }
+        }
+
+        fields.append(value);
+
+        return true;
+    }
+
+    static QString field(const QStringList& fields, int index)
+    {
+        return index >= 0 && index < fields.size() ? fields[index] : QString();
+    }
+
+    QFile& m_file;
+
+    int m_date { -1 };
+    int m_complete { -1 };
+    int m_title { -1 };
+    int m_description { -1 };
+    int m_tags { -1 };
+};
+
+// "# 2021-03-04" headings set date of following "- [ ] title #tag" items;
+// lines after an item, up to next item or heading, are its description
+class MarkdownReader : public RecordReader {
+public:
+    MarkdownReader(QFile& file, const QDate& date)
+        : m_file(file)
+        , m_date(date)
+    {
+    }
+
+    bool next(ImportRecord& rec) override
+    {
+        static const QRegularExpression headingRe("^#{1,6}\\s+(.*)$");
+        static const QRegularExpression dateRe("(\\d{4}-\\d{2}-\\d{2})");
+        static const QRegularExpression itemRe("^[-*+]\\s+(?:\\[([ xX])\\]\\s+)?(.*)$");
+        static const QRegularExpression tagRe("(^|\\s)#([^\\s#]+)");
+
+        bool inRecord = false;
+        QStringList description;
+
+        QString line;
+        qint64 pos {};
+
+        while (nextLine(line, pos)) {
+            const auto heading = headingRe.match(line);
+            const auto item = itemRe.match(line);
+
+            if (inRecord && (heading.hasMatch() || item.hasMatch())) {
+                // belongs to next record, which starts here
+                m_pending = line;
+                m_pendingPos = pos;
+                m_hasPending = true;
+
+                rec.endOffset = pos;
+                rec.description = joinDescription(description);
+
+                return true;
+            }
+
+            if (heading.hasMatch()) {
+                const auto date = dateRe.match(heading.captured(1));
+                if (date.hasMatch()) {
+                    m_date = QDate::fromString(date.captured(1), Qt::ISODate);
+                }
+                continue;
+            }
+
+            if (item.hasMatch()) {
+                inRecord = true;
+
+                rec = ImportRecord();
+                rec.date = m_date;
+                rec.complete = item.captured(1).compare("x", Qt::CaseInsensitive) == 0;
+
+                auto title = item.captured(2);
+
+                auto tags = tagRe.globalMatch(title);
+                while (tags.hasNext()) {
+                    rec.tags.append(tags.next().captured(2));
+                }
+
+                rec.title = title.remove(tagRe).simplified();
+                continue;
+            }
+
+            if (inRecord) {
+                description.append(dedent(line));
+            }
+        }
+
+        if (!inRecord) {
+            return false;
+        }
+
+        rec.endOffset = m_file.pos();
+        rec.description = joinDescription(description);
+
+        return true;
+    }
+
+private:
+    bool nextLine(QString& line, qint64& pos)
+    {
+        if (m_hasPending) {
+            m_hasPending = false;
+            line = m_pending;
+            pos = m_pendingPos;
+            return true;
+        }
+
+        if (m_file.atEnd()) {
+            return false;
+        }
+
+        pos = m_file.pos();
+        line = readLine(m_file);
+
+        return true;
+    }
+
+    static QString dedent(const QString& line)
+    {
+        if (line.startsWith('\t')) {
+            return line.mid(1);
+        }
+
+        int n = 0;
+        while (n < 4 && n < line.size() && line[n] == ' ') {
+            n++;
+        }
+        return line.mid(n);
+    }
+
+    static QString joinDescription(QStringList& lines)
+    {
+        while (!lines.isEmpty() && lines.first().trimmed().isEmpty()) {
+            lines.removeFirst();
+        }
+        while (!lines.isEmpty() && lines.last().trimmed().isEmpty()) {
+            lines.removeLast();
+        }
+        return lines.join('\n');
+    }
+
+    QFile& m_file;
+    QDate m_date;
+
+    QString m_pending;
+    qint64 m_pendingPos {};
+    bool m_hasPending {};
+};
+
+} // namespace
+
+Importer::Importer(const QString& path, Format format)
+    : m_path(path)
+    , m_format(format)
+{
+}
+
+void Importer::setDefaultDate(const QDate& date)
+{
+    m_defaultDate = date;
+}
+
+qint64 Importer::skippedRecords() const
+{
+    return m_skipped;
+}
+
+void Importer::setProgressHandler(std::function<void(qint64, qint64, qint64)> handler)
+{
+    m_progress = std::move(handler);
+}
+
+bool Importer::run()
+{
+    TRACE_SPAN("Importer::run");
+
+    m_skipped = 0;
+
+    QFile file(m_path);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical() << "can't open" << m_path;
+        return false;
+    }
+
+    const auto source = QFileInfo(m_path).canonicalFilePath();
+
+    Checkpoint checkpoint;
+
+    if (!readCheckpoint(source, checkpoint)) {
+        return false;
+    }
+
+    if (checkpoint.position > file.size()) {
+        qCritical() << m_path << "is shorter than on last import,"
+                    << "remove it from import_checkpoints to start over";
+        return false;
+    }
+
+    std::unique_ptr<RecordReader> reader;
+
+    if (m_format == Format::Csv) {
+        auto csvReader = std::make_unique<CsvReader>(file);
+        if (!csvReader->readHeader()) {
+            return false;
+        }
+        reader = std::move(csvReader);
+    } else {
+        reader = std::make_unique<MarkdownReader>(file, checkpoint.date);
+    }
+
+    if (checkpoint.position > 0) {
+        qInfo() << "resuming after" << checkpoint.records << "records";
+        file.seek(checkpoint.position);
+    }
+
+    if (!readTagIDs()) {
+        return false;
+    }
+
+    ImportRecord rec;
+    QVector<quint32> tagIDs;
+
+    bool more = reader->next(rec);
+
+    while (more) {
+        BulkWriter writer;
+
+        if (!writer.begin()) {
+            return false;
+        }
+
+        for (int n = 0; more && n < chunkSize; n++) {
+            // heading date of markdown is resumed from, not the default one
+            checkpoint.position = rec.endOffset;
+            checkpoint.date = rec.date;
+
+            if (!rec.date.isValid()) {
+                rec.date = m_defaultDate;
+            }
+
+            // records without date are not shown anywhere in app
+            if (!rec.date.isValid()) {
+                m_skipped++;
+                more = reader->next(rec);
+                continue;
+            }
+
+            quint32 id {};
+
+            if (!resolveTags(writer, rec.tags, tagIDs)
+                || !writer.addRecord(
+                    rec.date, rec.complete, rec.title, rec.description, tagIDs, id)) {
+                writer.rollback();
+                return false;
+            }
+
+            checkpoint.records++;
+
+            more = reader->next(rec);
+        }
+
+        if (!writeCheckpoint(source, checkpoint)) {
+            writer.rollback();
+            return false;
+        }
+
+        if (!writer.commit()) {
+            return false;
+        }
+
+        if (m_progress) {
+            m_progress(checkpoint.records, checkpoint.position, file.size());
+        }
+    }
+
+    return true;
+}
+
+bool Importer::readCheckpoint(const QString& source, Checkpoint& checkpoint)
+{
+    QSqlQuery query;
+
+    query.prepare("SELECT position, records, day FROM import_checkpoints"
+                  " WHERE source = (:source)");
+    query.bindValue(":source", source);
+
+    if (!query.exec()) {
+        qCritical() << "can't read import checkpoint";
+        return false;
+    }
+
+    if (query.next()) {
+        checkpoint.position = query.value(0).toLongLong();
+        checkpoint.records = query.value(1).toLongLong();
+        if (!query.isNull(2)) {
+            checkpoint.date = QDate::fromJulianDay(query.value(2).toLongLong());
+        }
+    }
+
+    return true;
+}
+
+bool Importer::writeCheckpoint(const QString& source, const Checkpoint& checkpoint)
+{
+    QSqlQuery query;
+
+    query.prepare("INSERT OR REPLACE INTO import_checkpoints"
+                  " (source, position, records, day)"
+                  " VALUES (:source, :position, :records, :day)");
+    query.bindValue(":source", source);
+    query.bindValue(":position", checkpoint.position);
+    query.bindValue(":records", checkpoint.records);
+    query.bindValue(":day",
+        checkpoint.date.isValid() ? QVariant(checkpoint.date.toJulianDay()) : QVariant());
+
+    if (!query.exec()) {
+        qCritical() << "can't write import checkpoint";
+        return false;
+    }
+
+    return true;
+}
+
+bool Importer::readTagIDs()
+{
+    m_tagIDs.clear();
+
+    QSqlQuery query;
+    query.setForwardOnly(true);
+
+    if (!query.exec("SELECT id, name FROM tags")) {
+        qCritical() << "can't read tags for import";
+        return false;
+    }
+
+    while (query.next()) {
+        m_tagIDs.insert(query.value(1).toString(), query.value(0).toUInt());
+    }
+
+    return true;
+}
+
+bool Importer::resolveTags(
+    BulkWriter& writer, const QStringList& names, QVector<quint32>& ids)
+{
+    ids.clear();
+
+    for (const auto& name : names) {
+        auto it = m_tagIDs.constFind(name);
+
+        if (it == m_tagIDs.constEnd()) {
+            quint32 id {};
+            if (!writer.addTag(name, id)) {
+                return false;
+            }
+            it = m_tagIDs.insert(name, id);
+        }
+
+        if (!ids.contains(it.value())) {
+            ids.append(it.value());
+        }
+    }
+
+    return true;
+}
+
+} // namespace tagberry::storage
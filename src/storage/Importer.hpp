@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QDate>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+namespace tagberry::storage {
+
+class BulkWriter;
+
+// Streams records from CSV (as written by Exporter) or from markdown
+// journal (date headings, "- [x] title #tag" items, indented lines as
+// description) into storage. Records are committed in chunks together
+// with their stats and file position, so interrupted import continues
+// where it stopped, and import of appended file picks up only new records.
+class Importer {
+public:
+    enum class Format { Csv, Markdown };
+
+    Importer(const QString& path, Format format);
+
+    // date of records having none, they are skipped if it's invalid
+    void setDefaultDate(const QDate& date);
+
+    // records without date skipped by last run()
+    qint64 skippedRecords() const;
+
+    // called after each committed chunk
+    void setProgressHandler(
+        std::function<void(qint64 records, qint64 position, qint64 size)>);
+
+    // into opened storage
+    bool run();
+
+private:
+    struct Checkpoint {
+        qint64 position {};
+        qint64 records {};
+        QDate date;
+    };
+
+    bool readCheckpoint(const QString& source, Checkpoint& checkpoint);
+    bool writeCheckpoint(const QString& source, const Checkpoint& checkpoint);
+
+    bool readTagIDs();
+    bool resolveTags(BulkWriter& writer, const QStringList& names, QVector<quint32>& ids);
+
+    QString m_path;
+    Format m_format;
+    std::function<void(qint64, qint64, qint64)> m_progress;
+
+    QDate m_defaultDate;
+    qint64 m_skipped {};
+
+    QHash<QString, quint32> m_tagIDs;
+};
+
+} // namespace tagberry::storage
@@ -9,12 +9,15 @@
 
 #include "storage/LocalStorage.hpp"
 #include "storage/Migrator.hpp"
+#include "trace/Trace.hpp"
 
 #include <QDebug>
 #include <QFile>
 #include <QSqlQuery>
 #include <QSqlRecord>
 
+#include <algorithm>
+
 namespace tagberry::storage {
 
 namespace {
@@ -34,26 +37,132 @@ std::unique_ptr<QLockFile> lockDB(QString path)
     return lock;
 }
 
-bool backupDB(QString path)
+// consistent copy made through separate read-only connection, including
+// commits still in WAL; with WAL it can run in another thread while app
+// keeps writing, without blocking its commits
+bool snapshotDB(const QString& path)
 {
-    if (!QFile::exists(path)) {
-        return true;
-    }
+    TRACE_SPAN("snapshotDB");
 
-    auto bakPath = path + ".bak";
+    const auto bakPath = path + ".bak";
+    const auto tmpPath = bakPath + ".tmp";
+    const QString connection = "backup";
 
     qDebug() << "copying" << path << "to" << bakPath;
 
+    if (QFile::exists(tmpPath)) {
+        QFile::remove(tmpPath);
+    }
+
+    bool ok = false;
+
+    {
+        auto db = QSqlDatabase::addDatabase("QSQLITE", connection);
+        db.setDatabaseName(path);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+
+        if (db.open()) {
+            QSqlQuery query(db);
+
+            query.prepare("VACUUM INTO (:path)");
+            query.bindValue(":path", tmpPath);
+
+            ok = query.exec();
+        }
+
+        db.close();
+    }
+
+    QSqlDatabase::removeDatabase(connection);
+
+    if (!ok) {
+        return false;
+    }
+
+    // previous backup is kept until new one is complete
     if (QFile::exists(bakPath)) {
         QFile::remove(bakPath);
     }
 
-    return QFile::copy(path, bakPath);
+    return QFile::rename(tmpPath, bakPath);
+}
+
+class BackupThread : public QThread {
+public:
+    explicit BackupThread(const QString& path)
+        : m_path(path)
+    {
+    }
+
+    bool succeeded() const
+    {
+        return m_ok;
+    }
+
+protected:
+    void run() override
+    {
+        m_ok = snapshotDB(m_path);
+    }
+
+private:
+    QString m_path;
+    bool m_ok {};
+};
+
+// turns user input into FTS5 query: every word is a quoted prefix term
+QString makeSearchQuery(const QString& text)
+{
+    auto words = text.simplified();
+    if (words.isEmpty()) {
+        return {};
+    }
+
+    QStringList terms;
+
+    for (auto word : words.split(' ')) {
+        word.replace('"', "\"\"");
+        terms.append('"' + word + "\"*");
+    }
+
+    return terms.join(' ');
+}
+
+// records.date is julian day number, NULL for records without date
+QVariant toDay(const QDate& date)
+{
+    return date.isValid() ? QVariant(date.toJulianDay()) : QVariant();
+}
+
+QDate fromDay(const QVariant& value)
+{
+    return value.isNull() ? QDate() : QDate::fromJulianDay(value.toLongLong());
+}
+
+// columns expected by readTag(), tags joined with tag_stats
+const QString tagColumns = "tags.id, tags.name, tags.color,"
+                           " tag_stats.total, tag_stats.open, tag_stats.last_used";
+
+models::TagPtr readTag(const QSqlQuery& query, models::TagsDirectory& tagDir)
+{
+    auto tag = tagDir.getOrCreateTag(query.value(0).toUInt());
+
+    // usage goes first, so that name is indexed for completion with it
+    tag->setUsage(
+        query.value(3).toInt(), query.value(4).toInt(), fromDay(query.value(5)));
+
+    tag->setName(query.value(1).toString());
+    if (!query.isNull(2)) {
+        tag->setColorIndex(query.value(2).toInt());
+    }
+    tag->unsetDirty();
+
+    return tag;
 }
 
 } // namespace
 
-bool LocalStorage::open(const QString& path)
+bool LocalStorage::open(const QString& path, bool validateSchema)
 {
     qDebug() << "opening" << path;
 
@@ -62,10 +171,9 @@ bool LocalStorage::open(const QString& path)
         return false;
     }
 
-    if (!backupDB(path)) {
-        qCritical() << "can't make backup";
-        return false;
-    }
+    trace::markPhase("lock db");
+
+    m_path = path;
 
     m_db = QSqlDatabase::addDatabase("QSQLITE");
     m_db.setDatabaseName(path);
@@ -75,18 +183,43 @@ bool LocalStorage::open(const QString& path)
         return false;
     }
 
-    if (!initTables()) {
-        qCritical() << "can't initialize tables";
+    // readers, like backup or tools running next to app, don't block
+    // commits; mode is persistent, so read-only connections get it too
+    QSqlQuery query;
+
+    if (!query.exec("PRAGMA journal_mode = WAL") || !query.next()
+        || query.value(0).toString() != "wal") {
+        qCritical() << "can't switch to WAL journal";
         return false;
     }
+    query.finish();
 
-    return true;
-}
+    trace::markPhase("open db");
 
-bool LocalStorage::initTables()
-{
     Migrator m(m_db);
 
+    // nothing is going to change schema, backup can wait and schema was
+    // validated when fingerprint was written
+    if (m.isCurrent()) {
+        qDebug() << "schema is up to date";
+        m_maintenancePending = true;
+        trace::markPhase("check schema");
+
+        if (validateSchema && !m.validate()) {
+            qCritical() << "can't validate db schema";
+            return false;
+        }
+
+        return true;
+    }
+
+    if (!snapshotDB(path)) {
+        qCritical() << "can't make backup";
+        return false;
+    }
+
+    trace::markPhase("backup db");
+
     if (!m.migrate()) {
         qCritical() << "can't apply migrations";
         return false;
@@ -97,25 +230,112 @@ bool LocalStorage::initTables()
         return false;
     }
 
+    if (!m.stampFingerprint()) {
+        return false;
+    }
+
+    trace::markPhase("migrate db");
+
+    return true;
+}
+
+bool LocalStorage::openReadOnly(const QString& path)
+{
+    qDebug() << "opening" << path << "read-only";
+
+    if (!QFile::exists(path)) {
+        qCritical() << "can't find" << path;
+        return false;
+    }
+
+    m_path = path;
+
+    m_db = QSqlDatabase::addDatabase("QSQLITE");
+    m_db.setDatabaseName(path);
+    m_db.setConnectOptions("QSQLITE_OPEN_READONLY");
+
+    if (!m_db.open()) {
+        qCritical() << "can't open" << path;
+        return false;
+    }
+
+    Migrator m(m_db);
+
+    if (!m.isCurrent()) {
+        qCritical() << "db schema is outdated, open it with tagberry-qt once";
+        return false;
+    }
+
     return true;
 }
 
+LocalStorage::~LocalStorage()
+{
+    if (m_backupThread) {
+        m_backupThread->wait();
+    }
+}
+
+bool LocalStorage::runMaintenance()
+{
+    if (!m_maintenancePending) {
+        return true;
+    }
+
+    m_maintenancePending = false;
+
+    if (!snapshotDB(m_path)) {
+        qCritical() << "can't make backup";
+        return false;
+    }
+
+    return true;
+}
+
+void LocalStorage::startMaintenance()
+{
+    if (!m_maintenancePending) {
+        maintenanceFinished(true);
+        return;
+    }
+
+    m_maintenancePending = false;
+
+    auto thread = new BackupThread(m_path);
+    m_backupThread.reset(thread);
+
+    connect(thread, &QThread::finished, this, [=] {
+        if (!thread->succeeded()) {
+            qCritical() << "can't make backup";
+        }
+        maintenanceFinished(thread->succeeded());
+    });
+
+    thread->start(QThread::LowPriority);
+}
+
 bool LocalStorage::saveTag(models::TagPtr tag)
 {
     if (!tag->isDirty()) {
         return true;
     }
 
+    if (!tag->hasColorIndex()) {
+        tag->setColorIndex(tag->colorIndex());
+    }
+
     QSqlQuery query;
 
     if (tag->hasID()) {
-        query.prepare("UPDATE tags SET name = (:name) WHERE id = (:id)");
+        query.prepare("UPDATE tags SET name = (:name), color = (:color) WHERE id = (:id)");
         query.bindValue(":id", tag->id());
     } else {
-        query.prepare("INSERT INTO tags (name) VALUES (:name)");
+        query.prepare("INSERT INTO tags (name, color) VALUES (:name, :color)");
     }
 
     query.bindValue(":name", tag->name());
+    query.bindValue(
+        ":color", tag->hasColorIndex() ? QVariant(tag->colorIndex()) : QVariant());
 
     if (!query.exec()) {
         qCritical() << "can't write tag";
@@ -123,7 +343,7 @@ bool LocalStorage::saveTag(models::TagPtr tag)
     }
 
     if (!tag->hasID()) {
-        tag->setID(query.lastInsertId().toString());
+        tag->setID(query.lastInsertId().toUInt());
     }
     tag->unsetDirty();
 
@@ -132,26 +352,79 @@ bool LocalStorage::saveTag(models::TagPtr tag)
 
 bool LocalStorage::saveRecord(models::RecordPtr record)
 {
-    if (!record->isDirty()) {
+    TRACE_SPAN("LocalStorage::saveRecord");
+
+    return saveRecords({ record });
+}
+
+bool LocalStorage::saveRecords(
+    const QList<models::RecordPtr>& records, const QList<models::RecordPtr>& removed)
+{
+    QList<models::RecordPtr> dirty;
+    QList<models::RecordPtr> gone;
+
+    for (auto record : records) {
+        if (record->isDirty()) {
+            dirty.append(record);
+        }
+    }
+
+    for (auto record : removed) {
+        if (record->hasID()) {
+            gone.append(record);
+        }
+    }
+
+    if (dirty.isEmpty() && gone.isEmpty()) {
         return true;
     }
 
-    for (auto tag : record->tags()) {
-        if (!saveTag(tag)) {
-            return false;
+    for (auto record : dirty) {
+        for (auto tag : record->tags()) {
+            if (!saveTag(tag)) {
+                return false;
+            }
         }
     }
 
     QSqlDatabase::database().transaction();
 
-    if (!saveRecordImp(record)) {
-        QSqlDatabase::database().rollback();
-        return false;
+    m_changedDays.clear();
+    m_changedTags.clear();
+
+    for (auto record : dirty) {
+        if (!saveRecordImp(record)) {
+            QSqlDatabase::database().rollback();
+            return false;
+        }
+    }
+
+    for (auto record : gone) {
+        if (!removeRecordImp(record)) {
+            QSqlDatabase::database().rollback();
+            return false;
+        }
     }
 
+    pruneChangeLog();
+
     QSqlDatabase::database().commit();
 
-    record->unsetDirty();
+    forgetOwnChanges();
+
+    notifyStats();
+
+    for (auto record : dirty) {
+        updateTagIndex(record);
+        record->unsetDirty();
+    }
+
+    if (m_tagIndex) {
+        for (auto record : gone) {
+            m_tagIndex->removeRecord(record->id());
+        }
+    }
+
     return true;
 }
 
@@ -160,6 +433,10 @@ bool LocalStorage::saveRecordImp(models::RecordPtr record)
     QSqlQuery query;
 
     if (record->hasID()) {
+        if (!updateRecordStats(record->id(), -1)) {
+            return false;
+        }
+
         query.prepare("DELETE FROM record2tag WHERE record = (:id)");
         query.bindValue(":id", record->id());
 
@@ -182,7 +459,7 @@ bool LocalStorage::saveRecordImp(models::RecordPtr record)
                       " VALUES (:date, :state, :title, :description)");
     }
 
-    query.bindValue(":date", QDateTime(record->date()).toTime_t());
+    query.bindValue(":date", toDay(record->date()));
     query.bindValue(":state", record->complete() ? 1 : 0);
     query.bindValue(":title", record->title());
     query.bindValue(":description", record->description());
@@ -193,7 +470,7 @@ bool LocalStorage::saveRecordImp(models::RecordPtr record)
     }
 
     if (!record->hasID()) {
-        record->setID(query.lastInsertId().toString());
+        record->setID(query.lastInsertId().toUInt());
     }
 
     for (auto tag : record->tags()) {
@@ -207,29 +484,26 @@ bool LocalStorage::saveRecordImp(models::RecordPtr record)
         }
     }
 
-    return true;
-}
-
-bool LocalStorage::removeRecord(models::RecordPtr record)
-{
-    if (!record->hasID()) {
-        return true;
-    }
-
-    QSqlDatabase::database().transaction();
-
-    if (!removeRecordImp(record)) {
-        QSqlDatabase::database().rollback();
+    if (!updateRecordStats(record->id(), +1)) {
         return false;
     }
 
-    QSqlDatabase::database().commit();
+    rememberOwnChange("records", record->id());
 
     return true;
 }
 
+bool LocalStorage::removeRecord(models::RecordPtr record)
+{
+    return saveRecords({}, { record });
+}
+
 bool LocalStorage::removeRecordImp(models::RecordPtr record)
 {
+    if (!updateRecordStats(record->id(), -1)) {
+        return false;
+    }
+
     QSqlQuery query;
 
     query.prepare("DELETE FROM record2tag WHERE record = (:record)");
@@ -248,86 +522,998 @@ bool LocalStorage::removeRecordImp(models::RecordPtr record)
         return false;
     }
 
+    rememberOwnChange("deleted_records", record->id());
+
     return true;
 }
 
-bool LocalStorage::readAllTags(models::TagsDirectory& tagDir)
+// adds (sign = +1) or subtracts (sign = -1) stored record from day_stats
+// and tag_stats
+bool LocalStorage::updateRecordStats(quint32 recordID, int sign)
 {
     QSqlQuery query;
 
-    if (!query.exec("SELECT * from tags")) {
-        qCritical() << "can't read tags";
+    query.prepare("SELECT records.date, records.state, record2tag.tag"
+                  " FROM records LEFT JOIN record2tag ON record2tag.record = records.id"
+                  " WHERE records.id = (:id)");
+    query.bindValue(":id", recordID);
+
+    if (!query.exec()) {
+        qCritical() << "can't read record stats";
         return false;
     }
 
-    auto indexTagID = query.record().indexOf("id");
-    auto indexTagName = query.record().indexOf("name");
+    QDate date;
+    int complete = 0;
+    QList<QVariant> tags;
 
     while (query.next()) {
-        auto tag = tagDir.getOrCreateTag(query.value(indexTagID).toString());
+        date = fromDay(query.value(0));
+
+        complete = query.value(1).toInt() == 1 ? 1 : 0;
+
+        if (!query.isNull(2)) {
+            tags.append(query.value(2));
+        }
+    }
 
-        tag->setName(query.value(indexTagName).toString());
-        tag->unsetDirty();
+    if (!date.isValid()) {
+        return true;
+    }
+
+    if (!updateDayStats(date, tags, complete, sign)) {
+        return false;
+    }
+
+    if (!updateTagStats(date, tags, complete, sign)) {
+        return false;
     }
 
     return true;
 }
 
-bool LocalStorage::readPage(const QPair<QDate, QDate> range,
-    models::RecordsDirectory& recDir, models::TagsDirectory& tagDir)
+bool LocalStorage::updateDayStats(
+    const QDate& date, const QList<QVariant>& tags, int complete, int sign)
 {
-    QSqlQuery recQuery;
+    QSqlQuery query;
 
-    recQuery.prepare("SELECT * from records WHERE date >= (:from) AND date <= (:to)");
-    recQuery.bindValue(":from", QDateTime(range.first).toTime_t());
-    recQuery.bindValue(":to", QDateTime(range.second).toTime_t());
+    const auto day = date.toJulianDay();
 
-    if (!recQuery.exec()) {
-        return false;
-    }
+    for (const auto& tag : QList<QVariant> { 0 } + tags) {
+        query.prepare("UPDATE day_stats SET"
+                      " total = total + (:total), complete = complete + (:complete)"
+                      " WHERE tag = (:tag) AND day = (:day)");
+        query.bindValue(":total", sign);
+        query.bindValue(":complete", sign * complete);
+        query.bindValue(":tag", tag);
+        query.bindValue(":day", day);
 
-    auto indexRecID = recQuery.record().indexOf("id");
-    auto indexRecDate = recQuery.record().indexOf("date");
-    auto indexRecState = recQuery.record().indexOf("state");
-    auto indexRecTitle = recQuery.record().indexOf("title");
-    auto indexRecDesc = recQuery.record().indexOf("description");
+        if (!query.exec()) {
+            qCritical() << "can't update day_stats";
+            return false;
+        }
 
-    while (recQuery.next()) {
-        auto rec = recDir.getOrCreateRecord(recQuery.value(indexRecID).toString());
+        if (query.numRowsAffected() != 0 || sign < 0) {
+            continue;
+        }
+
+        query.prepare("INSERT INTO day_stats (day, tag, total, complete)"
+                      " VALUES (:day, :tag, 1, :complete)");
+        query.bindValue(":day", day);
+        query.bindValue(":tag", tag);
+        query.bindValue(":complete", complete);
+
+        if (!query.exec()) {
+            qCritical() << "can't insert day_stats";
+            return false;
+        }
+    }
+
+    if (sign < 0) {
+        query.prepare("DELETE FROM day_stats WHERE day = (:day) AND total <= 0");
+        query.bindValue(":day", day);
 
-        QDateTime dt;
-        dt.setTime_t(uint(recQuery.value(indexRecDate).toInt()));
-        rec->setDate(dt.date());
+        if (!query.exec()) {
+            qCritical() << "can't cleanup day_stats";
+            return false;
+        }
+    }
 
-        rec->setComplete(recQuery.value(indexRecState).toInt() == 1);
-        rec->setTitle(recQuery.value(indexRecTitle).toString());
-        rec->setDescription(recQuery.value(indexRecDesc).toString());
+    m_changedDays.insert(date);
 
-        QSqlQuery tagQuery;
+    return true;
+}
 
-        tagQuery.prepare(
-            "SELECT * from tags INNER JOIN record2tag ON tags.id = record2tag.tag"
-            " WHERE record2tag.record = (:record)");
+// expects day_stats to be already updated
+bool LocalStorage::updateTagStats(
+    const QDate& date, const QList<QVariant>& tags, int complete, int sign)
+{
+    QSqlQuery query;
 
-        tagQuery.bindValue(":record", rec->id());
+    for (const auto& tag : tags) {
+        if (sign > 0) {
+            query.prepare("INSERT INTO tag_stats (tag, total, open, last_used)"
+                          " VALUES (:tag, 1, :open, :day)"
+                          " ON CONFLICT (tag) DO UPDATE SET"
+                          "  total = total + 1,"
+                          "  open = open + excluded.open,"
+                          "  last_used = MAX(IFNULL(last_used, 0), excluded.last_used)");
+            query.bindValue(":day", date.toJulianDay());
+        } else {
+            // last day is found via (tag, day) key of day_stats
+            query.prepare("UPDATE tag_stats SET"
+                          " total = total - 1,"
+                          " open = open - (:open),"
+                          " last_used = (SELECT MAX(day) FROM day_stats WHERE tag = (:lastTag))"
+                          " WHERE tag = (:tag)");
+            query.bindValue(":lastTag", tag);
+        }
+        query.bindValue(":tag", tag);
+        query.bindValue(":open", 1 - complete);
 
-        if (!tagQuery.exec()) {
+        if (!query.exec()) {
+            qCritical() << "can't update tag_stats";
             return false;
         }
 
-        auto indexTagID = tagQuery.record().indexOf("id");
-        auto indexTagName = tagQuery.record().indexOf("name");
+        m_changedTags.insert(tag.toUInt());
+    }
+
+    return true;
+}
 
-        while (tagQuery.next()) {
-            auto tag = tagDir.getOrCreateTag(tagQuery.value(indexTagID).toString());
+void LocalStorage::notifyStats()
+{
+    auto days = m_changedDays;
+    auto tags = m_changedTags;
 
-            tag->setName(tagQuery.value(indexTagName).toString());
-            tag->unsetDirty();
+    m_changedDays.clear();
+    m_changedTags.clear();
 
-            rec->addTag(tag);
-        }
+    for (const auto& date : days) {
+        dayStatsChanged(date);
+    }
+
+    for (const auto& tagID : tags) {
+        tagStatsChanged(tagID);
+    }
+}
+
+bool LocalStorage::readDayStats(
+    const QDate& from, const QDate& to, quint32 tagID, QList<DayStats>& stats)
+{
+    QSqlQuery query;
+
+    query.setForwardOnly(true);
+    query.prepare("SELECT day, total, complete FROM day_stats"
+                  " WHERE tag = (:tag) AND day >= (:from) AND day <= (:to)");
+    query.bindValue(":tag", tagID);
+    query.bindValue(":from", from.toJulianDay());
+    query.bindValue(":to", to.toJulianDay());
+
+    if (!query.exec()) {
+        qCritical() << "can't read day_stats";
+        return false;
+    }
+
+    while (query.next()) {
+        DayStats day;
+
+        day.date = QDate::fromJulianDay(query.value(0).toLongLong());
+        day.total = query.value(1).toInt();
+        day.complete = query.value(2).toInt();
+
+        stats.append(day);
+    }
+
+    return true;
+}
+
+bool LocalStorage::rebuildDayStats(const QDate& date)
+{
+    QSqlQuery query;
+
+    const auto day = date.toJulianDay();
+
+    // tags counted on this day before, they may have no records there now
+    query.prepare("SELECT tag FROM day_stats WHERE day = (:day) AND tag != 0");
+    query.bindValue(":day", day);
+
+    if (!query.exec()) {
+        qCritical() << "can't read day_stats";
+        return false;
+    }
+
+    while (query.next()) {
+        m_changedTags.insert(query.value(0).toUInt());
+    }
+
+    const char* statements[] = {
+        "DELETE FROM day_stats WHERE day = (:day)",
+
+        "INSERT INTO day_stats (day, tag, total, complete)"
+        " SELECT date, 0, COUNT(*), SUM(state = 1)"
+        " FROM records WHERE date = (:day) GROUP BY date",
+
+        "INSERT INTO day_stats (day, tag, total, complete)"
+        " SELECT records.date, record2tag.tag, COUNT(*), SUM(records.state = 1)"
+        " FROM records INNER JOIN record2tag ON record2tag.record = records.id"
+        " WHERE records.date = (:day)"
+        " GROUP BY record2tag.tag",
+    };
+
+    for (auto statement : statements) {
+        query.prepare(statement);
+        query.bindValue(":day", day);
+
+        if (!query.exec()) {
+            qCritical() << "can't rebuild day_stats";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// expects day_stats to be already rebuilt
+bool LocalStorage::rebuildTagStats(quint32 tagID)
+{
+    const char* statements[] = {
+        "DELETE FROM tag_stats WHERE tag = (:tag)",
+
+        "INSERT INTO tag_stats (tag, total, open, last_used)"
+        " SELECT tag, SUM(total), SUM(total - complete), MAX(day)"
+        " FROM day_stats WHERE tag = (:tag) GROUP BY tag",
+    };
+
+    QSqlQuery query;
+
+    for (auto statement : statements) {
+        query.prepare(statement);
+        query.bindValue(":tag", tagID);
+
+        if (!query.exec()) {
+            qCritical() << "can't rebuild tag_stats";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool LocalStorage::readTagStats(QList<TagStats>& stats)
+{
+    QSqlQuery query;
+
+    query.setForwardOnly(true);
+
+    if (!query.exec("SELECT tags.id, tags.name,"
+                    " tag_stats.total, tag_stats.open, tag_stats.last_used"
+                    " FROM tags LEFT JOIN tag_stats ON tag_stats.tag = tags.id")) {
+        qCritical() << "can't read tag_stats";
+        return false;
+    }
+
+    while (query.next()) {
+        TagStats tag;
+
+        tag.tagID = query.value(0).toUInt();
+        tag.name = query.value(1).toString();
+        tag.total = query.value(2).toInt();
+        tag.open = query.value(3).toInt();
+        if (!query.isNull(4)) {
+            tag.lastUsed = QDate::fromJulianDay(query.value(4).toLongLong());
+        }
+
+        stats.append(tag);
+    }
+
+    return true;
+}
+
+bool LocalStorage::readTagStats(quint32 tagID, TagStats& stats)
+{
+    QSqlQuery query;
+
+    query.prepare("SELECT tags.name, tag_stats.total, tag_stats.open, tag_stats.last_used"
+                  " FROM tags LEFT JOIN tag_stats ON tag_stats.tag = tags.id"
+                  " WHERE tags.id = (:id)");
+    query.bindValue(":id", tagID);
+
+    if (!query.exec()) {
+        qCritical() << "can't read tag_stats";
+        return false;
+    }
+
+    if (!query.next()) {
+        return false;
+    }
+
+    stats.tagID = tagID;
+    stats.name = query.value(0).toString();
+    stats.total = query.value(1).toInt();
+    stats.open = query.value(2).toInt();
+    if (!query.isNull(3)) {
+        stats.lastUsed = QDate::fromJulianDay(query.value(3).toLongLong());
+    }
+
+    return true;
+}
+
+bool LocalStorage::readTagNames(models::TagsDirectory& tagDir)
+{
+    QSqlQuery query;
+    query.setForwardOnly(true);
+
+    if (!query.exec("SELECT tags.name, tag_stats.total"
+                    " FROM tags LEFT JOIN tag_stats ON tag_stats.tag = tags.id")) {
+        qCritical() << "can't read tag names";
+        return false;
+    }
+
+    while (query.next()) {
+        tagDir.indexTagName(query.value(0).toString(), query.value(1).toInt());
+    }
+
+    return true;
+}
+
+models::TagPtr LocalStorage::loadTagByID(models::TagsDirectory& tagDir, quint32 id)
+{
+    QSqlQuery query;
+
+    query.prepare("SELECT " + tagColumns
+        + " FROM tags LEFT JOIN tag_stats ON tag_stats.tag = tags.id"
+          " WHERE tags.id = (:id)");
+    query.bindValue(":id", id);
+
+    if (!query.exec()) {
+        qCritical() << "can't read tag";
+        return {};
+    }
+
+    if (!query.next()) {
+        return {};
+    }
+
+    return readTag(query, tagDir);
+}
+
+models::TagPtr LocalStorage::loadTagByName(
+    models::TagsDirectory& tagDir, const QString& name)
+{
+    QSqlQuery query;
+
+    query.prepare("SELECT " + tagColumns
+        + " FROM tags LEFT JOIN tag_stats ON tag_stats.tag = tags.id"
+          " WHERE tags.name = (:name)");
+    query.bindValue(":name", name);
+
+    if (!query.exec()) {
+        qCritical() << "can't read tag";
+        return {};
+    }
+
+    if (!query.next()) {
+        return {};
+    }
+
+    return readTag(query, tagDir);
+}
+
+bool LocalStorage::readTagIndex(models::TagIndex& tagIndex)
+{
+    if (m_tagIndex == &tagIndex) {
+        return true;
+    }
+
+    TRACE_SPAN("LocalStorage::readTagIndex");
+
+    m_tagIndex = nullptr;
+
+    tagIndex.clear();
+
+    QSqlQuery query;
+    query.setForwardOnly(true);
+
+    if (!query.exec("SELECT id, date, state FROM records")) {
+        qCritical() << "can't read records for tag index";
+        return false;
+    }
+
+    while (query.next()) {
+        tagIndex.setRecord(query.value(0).toUInt(), fromDay(query.value(1)),
+            query.value(2).toInt() == 1);
+    }
+
+    if (!query.exec("SELECT record, tag FROM record2tag")) {
+        qCritical() << "can't read record2tag for tag index";
+        return false;
+    }
+
+    while (query.next()) {
+        tagIndex.addRecordTag(query.value(0).toUInt(), query.value(1).toUInt());
+    }
+
+    qDebug() << "indexed" << tagIndex.recordCount() << "records";
+
+    m_tagIndex = &tagIndex;
+
+    return true;
+}
+
+void LocalStorage::updateTagIndex(models::RecordPtr record)
+{
+    if (!m_tagIndex) {
+        return;
+    }
+
+    const auto recordID = record->id();
+
+    m_tagIndex->setRecord(recordID, record->date(), record->complete());
+
+    for (auto tag : record->tags()) {
+        m_tagIndex->addRecordTag(recordID, tag->id());
+    }
+}
+
+bool LocalStorage::readPage(const QPair<QDate, QDate> range,
+    models::RecordsDirectory& recDir, models::TagsDirectory& tagDir)
+{
+    TRACE_SPAN("LocalStorage::readPage");
+
+    QSqlQuery recQuery;
+
+    recQuery.prepare("SELECT * from records WHERE date >= (:from) AND date <= (:to)");
+    recQuery.bindValue(":from", range.first.toJulianDay());
+    recQuery.bindValue(":to", range.second.toJulianDay());
+
+    if (!recQuery.exec()) {
+        return false;
+    }
+
+    auto indexRecID = recQuery.record().indexOf("id");
+    auto indexRecDate = recQuery.record().indexOf("date");
+    auto indexRecState = recQuery.record().indexOf("state");
+    auto indexRecTitle = recQuery.record().indexOf("title");
+    auto indexRecDesc = recQuery.record().indexOf("description");
+
+    while (recQuery.next()) {
+        const auto recordID = recQuery.value(indexRecID).toUInt();
+
+        auto row = recDir.loadRecord(recordID, fromDay(recQuery.value(indexRecDate)),
+            recQuery.value(indexRecState).toInt() == 1,
+            recQuery.value(indexRecTitle).toString(),
+            recQuery.value(indexRecDesc).toString());
+
+        QList<models::TagPtr> tags;
+
+        if (!readRecordTags(recordID, tagDir, tags)) {
+            return false;
+        }
+
+        recDir.loadRecordTags(row, tags);
+    }
+
+    return true;
+}
+
+models::RecordPtr LocalStorage::readRecord(quint32 id, models::TagsDirectory& tagDir)
+{
+    QSqlQuery query;
+
+    query.prepare("SELECT date, state, title, description FROM records"
+                  " WHERE id = (:id)");
+    query.bindValue(":id", id);
+
+    if (!query.exec()) {
+        qCritical() << "can't read record";
+        return {};
+    }
+
+    if (!query.next()) {
+        return {};
+    }
+
+    auto record = std::make_shared<models::Record>();
+
+    record->setID(id);
+    record->setDate(fromDay(query.value(0)));
+    record->setComplete(query.value(1).toInt() == 1);
+    record->setTitle(query.value(2).toString());
+    record->setDescription(query.value(3).toString());
+
+    QList<models::TagPtr> tags;
+
+    if (!readRecordTags(id, tagDir, tags)) {
+        return {};
+    }
+
+    record->setTags(tags);
+    record->unsetDirty();
+
+    return record;
+}
+
+bool LocalStorage::readRecordTags(
+    quint32 recordID, models::TagsDirectory& tagDir, QList<models::TagPtr>& tags)
+{
+    QSqlQuery query;
+
+    query.prepare("SELECT " + tagColumns
+        + " FROM tags INNER JOIN record2tag ON tags.id = record2tag.tag"
+          " LEFT JOIN tag_stats ON tag_stats.tag = tags.id"
+          " WHERE record2tag.record = (:record)");
+
+    query.bindValue(":record", recordID);
+
+    if (!query.exec()) {
+        return false;
+    }
+
+    while (query.next()) {
+        tags.append(readTag(query, tagDir));
+    }
+
+    return true;
+}
+
+void LocalStorage::watchExternalChanges()
+{
+    if (m_watching) {
+        return;
+    }
+
+    QSqlQuery query;
+
+    if (!query.exec("PRAGMA data_version") || !query.next()) {
+        qCritical() << "can't read data version";
+        return;
+    }
+    m_dataVersion = query.value(0).toLongLong();
+
+    if (!query.exec("SELECT value FROM change_counter") || !query.next()) {
+        qCritical() << "can't read change counter";
+        return;
+    }
+    m_lastChange = query.value(0).toLongLong();
+
+    m_watching = true;
+
+    // page was read after these, so they are not needed anymore
+    pruneChangeLog();
+
+    // watcher reacts at once, polling covers filesystems without
+    // notifications and files replaced by sync tools; commits of other
+    // connections go to WAL first
+    const QStringList paths = { m_path, m_path + "-wal" };
+
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, [=] {
+        for (const auto& path : paths) {
+            if (!m_watcher.files().contains(path) && QFile::exists(path)) {
+                m_watcher.addPath(path);
+            }
+        }
+        checkExternalChanges();
+    });
+
+    for (const auto& path : paths) {
+        if (QFile::exists(path)) {
+            m_watcher.addPath(path);
+        }
+    }
+
+    m_pollTimer.setInterval(3000);
+    connect(&m_pollTimer, &QTimer::timeout, this, &LocalStorage::checkExternalChanges);
+    m_pollTimer.start();
+}
+
+void LocalStorage::checkExternalChanges()
+{
+    QSqlQuery query;
+
+    if (!query.exec("PRAGMA data_version") || !query.next()) {
+        qCritical() << "can't read data version";
+        return;
+    }
+
+    const auto version = query.value(0).toLongLong();
+    if (version == m_dataVersion) {
+        return;
+    }
+    m_dataVersion = version;
+
+    TRACE_SPAN("LocalStorage::checkExternalChanges");
+
+    QList<quint32> changedIDs;
+    QList<quint32> removedIDs;
+
+    m_changedDays.clear();
+    m_changedTags.clear();
+
+    // derived tables are not maintained by other writers
+    QSqlDatabase::database().transaction();
+
+    if (!readExternalChanges(changedIDs, removedIDs)) {
+        QSqlDatabase::database().rollback();
+        return;
+    }
+
+    // only days touched by changes, and tags counted on them before or now
+    for (const auto& date : m_changedDays) {
+        if (!rebuildDayStats(date)) {
+            QSqlDatabase::database().rollback();
+            return;
+        }
+    }
+
+    for (auto tagID : m_changedTags) {
+        if (!rebuildTagStats(tagID)) {
+            QSqlDatabase::database().rollback();
+            return;
+        }
+    }
+
+    pruneChangeLog();
+
+    QSqlDatabase::database().commit();
+
+    if (changedIDs.isEmpty() && removedIDs.isEmpty()) {
+        return;
+    }
+
+    qDebug() << "external changes:" << changedIDs.size() << "records changed,"
+             << removedIDs.size() << "removed";
+
+    notifyStats();
+
+    recordsChangedExternally(changedIDs, removedIDs);
+}
+
+bool LocalStorage::readExternalChanges(
+    QList<quint32>& changedIDs, QList<quint32>& removedIDs)
+{
+    QSqlQuery query;
+    query.setForwardOnly(true);
+
+    auto lastChange = m_lastChange;
+
+    // tag writes don't restamp record having latest value, see M14
+    query.prepare("SELECT id, date, state, updated_at FROM records"
+                  " WHERE updated_at >= (:since)");
+    query.bindValue(":since", m_lastChange);
+
+    if (!query.exec()) {
+        qCritical() << "can't read changed records";
+        return false;
+    }
+
+    while (query.next()) {
+        const auto change = query.value(3).toLongLong();
+        lastChange = std::max(lastChange, change);
+
+        if (m_ownChanges.contains(change)) {
+            continue;
+        }
+
+        const auto recordID = query.value(0).toUInt();
+        const auto date = fromDay(query.value(1));
+
+        changedIDs.append(recordID);
+        m_changedDays.insert(date);
+
+        if (m_tagIndex) {
+            m_tagIndex->setRecord(recordID, date, query.value(2).toInt() == 1);
+        }
+    }
+
+    query.prepare("SELECT id, date, updated_at FROM deleted_records"
+                  " WHERE updated_at > (:since)");
+    query.bindValue(":since", m_lastChange);
+
+    if (!query.exec()) {
+        qCritical() << "can't read deleted records";
+        return false;
+    }
+
+    while (query.next()) {
+        const auto change = query.value(2).toLongLong();
+        lastChange = std::max(lastChange, change);
+
+        if (m_ownChanges.contains(change)) {
+            continue;
+        }
+
+        const auto recordID = query.value(0).toUInt();
+
+        removedIDs.append(recordID);
+        m_changedDays.insert(fromDay(query.value(1)));
+
+        if (m_tagIndex) {
+            m_tagIndex->removeRecord(recordID);
+        }
+    }
+
+    // records moved away from these days
+    query.prepare("SELECT date, updated_at FROM moved_records"
+                  " WHERE updated_at > (:since)");
+    query.bindValue(":since", m_lastChange);
+
+    if (!query.exec()) {
+        qCritical() << "can't read moved records";
+        return false;
+    }
+
+    while (query.next()) {
+        const auto change = query.value(1).toLongLong();
+        lastChange = std::max(lastChange, change);
+
+        if (m_ownChanges.contains(change)) {
+            continue;
+        }
+
+        m_changedDays.insert(fromDay(query.value(0)));
+    }
+
+    for (auto recordID : changedIDs) {
+        query.prepare("SELECT tag FROM record2tag WHERE record = (:record)");
+        query.bindValue(":record", recordID);
+
+        if (!query.exec()) {
+            qCritical() << "can't read record2tag";
+            return false;
+        }
+
+        while (query.next()) {
+            const auto tagID = query.value(0).toUInt();
+
+            m_changedTags.insert(tagID);
+
+            if (m_tagIndex) {
+                m_tagIndex->addRecordTag(recordID, tagID);
+            }
+        }
+    }
+
+    m_changedDays.remove(QDate());
+
+    m_lastChange = lastChange;
+    m_ownChanges.clear();
+
+    return true;
+}
+
+void LocalStorage::rememberOwnChange(const QString& table, quint32 recordID)
+{
+    if (!m_watching) {
+        return;
+    }
+
+    QSqlQuery query;
+
+    query.prepare("SELECT updated_at FROM " + table + " WHERE id = (:id)");
+    query.bindValue(":id", recordID);
+
+    if (query.exec() && query.next()) {
+        m_ownChanges.insert(query.value(0).toLongLong());
+    }
+}
+
+// drops tombstones and moved days already read, piggybacking on write
+// transactions that happen anyway, so that tables don't grow between restarts
+void LocalStorage::pruneChangeLog()
+{
+    if (!m_watching) {
+        return;
+    }
+
+    QSqlQuery query;
+
+    for (const QString table : { "deleted_records", "moved_records" }) {
+        query.prepare("DELETE FROM " + table + " WHERE updated_at <= (:lastChange)");
+        query.bindValue(":lastChange", m_lastChange);
+
+        if (!query.exec()) {
+            qCritical() << "can't prune" << table;
+        }
+    }
+}
+
+// if no other connection committed since last check, all changes up to
+// current counter value are own, and remembered values can't match anymore
+void LocalStorage::forgetOwnChanges()
+{
+    if (!m_watching) {
+        return;
+    }
+
+    QSqlQuery query;
+
+    if (!query.exec("PRAGMA data_version") || !query.next()) {
+        qCritical() << "can't read data version";
+        return;
+    }
+
+    if (query.value(0).toLongLong() != m_dataVersion) {
+        return;
+    }
+
+    if (!query.exec("SELECT value FROM change_counter") || !query.next()) {
+        qCritical() << "can't read change counter";
+        return;
+    }
+
+    m_lastChange = query.value(0).toLongLong();
+    m_ownChanges.clear();
+}
+
+bool LocalStorage::reloadRecords(const QPair<QDate, QDate> range,
+    const QList<quint32>& changedIDs, const QList<quint32>& removedIDs,
+    models::RecordsDirectory& recDir, models::TagsDirectory& tagDir)
+{
+    TRACE_SPAN("LocalStorage::reloadRecords");
+
+    for (auto recordID : removedIDs) {
+        recDir.unloadRecord(recordID);
+    }
+
+    QSqlQuery query;
+
+    for (auto recordID : changedIDs) {
+        query.prepare("SELECT date, state, title, description FROM records"
+                      " WHERE id = (:id)");
+        query.bindValue(":id", recordID);
+
+        if (!query.exec()) {
+            qCritical() << "can't read changed record";
+            return false;
+        }
+
+        const auto date = query.next() ? fromDay(query.value(0)) : QDate();
+
+        // removed since then, or moved out of page
+        if (!date.isValid() || date < range.first || date > range.second) {
+            recDir.unloadRecord(recordID);
+            continue;
+        }
+
+        auto row = recDir.loadRecord(recordID, date, query.value(1).toInt() == 1,
+            query.value(2).toString(), query.value(3).toString());
+
+        QList<models::TagPtr> tags;
+
+        if (!readRecordTags(recordID, tagDir, tags)) {
+            return false;
+        }
+
+        recDir.loadRecordTags(row, tags);
+    }
+
+    return true;
+}
+
+bool LocalStorage::findRecords(const RecordFilter& filter,
+    const std::function<void(const RecordRow&)>& callback)
+{
+    TRACE_SPAN("LocalStorage::findRecords");
+
+    QString sql = "SELECT records.id, records.date, records.state, records.title,"
+                  " (SELECT group_concat(tags.name, char(10)) FROM record2tag"
+                  "  INNER JOIN tags ON tags.id = record2tag.tag"
+                  "  WHERE record2tag.record = records.id)"
+                  " FROM records WHERE records.date IS NOT NULL";
+
+    if (filter.from.isValid()) {
+        sql += " AND records.date >= (:from)";
+    }
+    if (filter.to.isValid()) {
+        sql += " AND records.date <= (:to)";
+    }
+    if (filter.state != RecordFilter::State::Any) {
+        sql += " AND records.state = (:state)";
+    }
+
+    for (int n = 0; n < filter.tags.size(); n++) {
+        sql += QString(" AND records.id IN (SELECT record2tag.record FROM record2tag"
+                       "  INNER JOIN tags ON tags.id = record2tag.tag"
+                       "  WHERE tags.name = (:tag%1))")
+                   .arg(n);
+    }
+
+    sql += " ORDER BY records.date, records.id";
+
+    QSqlQuery query;
+    query.setForwardOnly(true);
+    query.prepare(sql);
+
+    if (filter.from.isValid()) {
+        query.bindValue(":from", filter.from.toJulianDay());
+    }
+    if (filter.to.isValid()) {
+        query.bindValue(":to", filter.to.toJulianDay());
+    }
+    if (filter.state != RecordFilter::State::Any) {
+        query.bindValue(":state", filter.state == RecordFilter::State::Complete ? 1 : 0);
+    }
+
+    for (int n = 0; n < filter.tags.size(); n++) {
+        query.bindValue(QString(":tag%1").arg(n), filter.tags[n]);
+    }
+
+    if (!query.exec()) {
+        qCritical() << "can't find records";
+        return false;
+    }
+
+    RecordRow row;
+
+    while (query.next()) {
+        row.id = query.value(0).toUInt();
+        row.date = fromDay(query.value(1));
+        row.complete = query.value(2).toInt() == 1;
+        row.title = query.value(3).toString();
+        row.tags = query.isNull(4) ? QStringList()
+                                   : query.value(4).toString().split('\n');
+
+        callback(row);
+    }
+
+    return true;
+}
+
+bool LocalStorage::searchRecords(
+    const QString& text, const SearchHit& after, int limit, QList<SearchHit>& hits)
+{
+    auto searchQuery = makeSearchQuery(text);
+    if (searchQuery.isEmpty()) {
+        return true;
+    }
+
+    QSqlQuery query;
+
+    // keyset paging, so that next page doesn't rank and skip previous ones
+    QString sql = "SELECT records.id, records.date, records.state, records.title,"
+                  " snippet(records_fts, -1, '', '', '...', 12), records_fts.rank"
+                  " FROM records_fts INNER JOIN records ON records.id = records_fts.rowid"
+                  " WHERE records_fts MATCH (:query)";
+
+    if (after.recordID) {
+        sql += " AND (records_fts.rank > (:rank)"
+               "  OR (records_fts.rank = (:sameRank) AND records_fts.rowid > (:id)))";
+    }
+
+    sql += " ORDER BY records_fts.rank, records_fts.rowid LIMIT (:limit)";
+
+    query.setForwardOnly(true);
+    query.prepare(sql);
+
+    query.bindValue(":query", searchQuery);
+    query.bindValue(":limit", limit);
+
+    if (after.recordID) {
+        query.bindValue(":rank", after.rank);
+        query.bindValue(":sameRank", after.rank);
+        query.bindValue(":id", after.recordID);
+    }
+
+    if (!query.exec()) {
+        qCritical() << "can't search records";
+        return false;
+    }
+
+    while (query.next()) {
+        SearchHit hit;
+
+        hit.recordID = query.value(0).toUInt();
+
+        hit.date = fromDay(query.value(1));
+
+        hit.complete = query.value(2).toInt() == 1;
+        hit.title = query.value(3).toString();
+        hit.snippet = query.value(4).toString();
+        hit.rank = query.value(5).toDouble();
 
-        rec->unsetDirty();
+        hits.append(hit);
     }
 
     return true;
@@ -9,40 +9,198 @@
 
 #pragma once
 
+#include "models/ColorScheme.hpp"
 #include "models/RecordsDirectory.hpp"
+#include "models/TagIndex.hpp"
+#include "models/TagSource.hpp"
 #include "models/TagsDirectory.hpp"
 
 #include <QDate>
+#include <QFileSystemWatcher>
 #include <QLockFile>
+#include <QObject>
+#include <QSet>
 #include <QSqlDatabase>
+#include <QThread>
+#include <QTimer>
 
+#include <functional>
 #include <memory>
 
 namespace tagberry::storage {
 
-class LocalStorage {
+struct SearchHit {
+    quint32 recordID {};
+    QDate date;
+    bool complete {};
+    QString title;
+    QString snippet;
+    // bm25 score, lower is better
+    double rank {};
+};
+
+struct DayStats {
+    QDate date;
+    int total {};
+    int complete {};
+};
+
+// records having all of tags, in [from; to] (open if invalid), of given state
+struct RecordFilter {
+    enum class State { Any, Open, Complete };
+
+    QStringList tags;
+    QDate from;
+    QDate to;
+    State state { State::Any };
+};
+
+struct RecordRow {
+    quint32 id {};
+    QDate date;
+    bool complete {};
+    QString title;
+    QStringList tags;
+};
+
+struct TagStats {
+    quint32 tagID {};
+    QString name;
+    int total {};
+    int open {};
+    QDate lastUsed;
+};
+
+class LocalStorage : public QObject, public models::TagSource {
+    Q_OBJECT
+
 public:
-    bool open(const QString& path);
+    ~LocalStorage() override;
+
+    // full schema validation runs after migrations, or always if
+    // validateSchema is set
+    bool open(const QString& path, bool validateSchema = false);
+
+    // for tools running next to app: no lock, backup or migrations,
+    // schema must be already up to date
+    bool openReadOnly(const QString& path);
+
+    // backup, postponed by open() if schema was already up to date
+    bool runMaintenance();
+
+    // same in worker thread, for app once UI is shown; doesn't block
+    // writes, result is reported by maintenanceFinished()
+    void startMaintenance();
 
     bool saveTag(models::TagPtr tag);
 
     bool saveRecord(models::RecordPtr record);
 
+    // saves dirty records and removes given ones in one transaction,
+    // all or none
+    bool saveRecords(const QList<models::RecordPtr>& records,
+        const QList<models::RecordPtr>& removed = {});
+
     bool removeRecord(models::RecordPtr record);
 
-    bool readAllTags(models::TagsDirectory& tagDir);
+    // fills completion index of directory, without loading tags
+    bool readTagNames(models::TagsDirectory& tagDir);
+
+    models::TagPtr loadTagByID(models::TagsDirectory& tagDir, quint32 id) override;
+    models::TagPtr loadTagByName(
+        models::TagsDirectory& tagDir, const QString& name) override;
+
+    // builds index over whole db and keeps it updated on subsequent writes;
+    // cheap if it's already kept, so it's called before each use
+    bool readTagIndex(models::TagIndex& tagIndex);
+
+    // detached record, not bound to page; null if there is no such record
+    models::RecordPtr readRecord(quint32 id, models::TagsDirectory& tagDir);
 
     bool readPage(const QPair<QDate, QDate> range, models::RecordsDirectory& recDir,
         models::TagsDirectory& tagDir);
 
-private:
-    bool initTables();
+    // starts noticing commits made to db by other processes, which are
+    // reported by recordsChangedExternally()
+    void watchExternalChanges();
+
+    // applies reported changes to page, reading only changed records
+    bool reloadRecords(const QPair<QDate, QDate> range,
+        const QList<quint32>& changedIDs, const QList<quint32>& removedIDs,
+        models::RecordsDirectory& recDir, models::TagsDirectory& tagDir);
+
+    // streams matching records ordered by date, without building models
+    bool findRecords(const RecordFilter& filter,
+        const std::function<void(const RecordRow&)>& callback);
+
+    // full-text search over record titles and descriptions, best matches first;
+    // continues after given hit, or from start if it has no record id
+    bool searchRecords(const QString& text, const SearchHit& after, int limit,
+        QList<SearchHit>& hits);
+
+    // per-day counters for [from; to], of all records if tagID is zero
+    bool readDayStats(
+        const QDate& from, const QDate& to, quint32 tagID, QList<DayStats>& stats);
 
+    // usage counters of all tags, without scanning record2tag
+    bool readTagStats(QList<TagStats>& stats);
+    bool readTagStats(quint32 tagID, TagStats& stats);
+
+signals:
+    void maintenanceFinished(bool ok);
+
+    void dayStatsChanged(QDate);
+    void tagStatsChanged(quint32);
+
+    void recordsChangedExternally(QList<quint32> changedIDs, QList<quint32> removedIDs);
+
+private:
     bool saveRecordImp(models::RecordPtr record);
     bool removeRecordImp(models::RecordPtr record);
 
+    bool updateRecordStats(quint32 recordID, int sign);
+    bool updateDayStats(
+        const QDate& date, const QList<QVariant>& tags, int complete, int sign);
+    bool updateTagStats(
+        const QDate& date, const QList<QVariant>& tags, int complete, int sign);
+    void notifyStats();
+
+    // recompute stats of one day or tag from records, for changes made by
+    // other writers
+    bool rebuildDayStats(const QDate& date);
+    bool rebuildTagStats(quint32 tagID);
+
+    void updateTagIndex(models::RecordPtr record);
+
+    bool readRecordTags(
+        quint32 recordID, models::TagsDirectory& tagDir, QList<models::TagPtr>& tags);
+
+    void checkExternalChanges();
+    bool readExternalChanges(QList<quint32>& changedIDs, QList<quint32>& removedIDs);
+    void rememberOwnChange(const QString& table, quint32 recordID);
+    void forgetOwnChanges();
+    void pruneChangeLog();
+
     std::unique_ptr<QLockFile> m_lock;
     QSqlDatabase m_db;
+    QString m_path;
+    bool m_maintenancePending {};
+    std::unique_ptr<QThread> m_backupThread;
+
+    models::TagIndex* m_tagIndex {};
+
+    QSet<QDate> m_changedDays;
+    QSet<quint32> m_changedTags;
+
+    QFileSystemWatcher m_watcher;
+    QTimer m_pollTimer;
+    bool m_watching {};
+
+    // PRAGMA data_version changes only on commits of other connections,
+    // updated_at values of own commits are skipped
+    qint64 m_dataVersion {};
+    qint64 m_lastChange {};
+    QSet<qint64> m_ownChanges;
 };
 
 } // namespace tagberry::storage
@@ -12,8 +12,23 @@
 #include "storage/migrations/01_CreateTables.hpp"
 #include "storage/migrations/02_AddRecordState.hpp"
 #include "storage/migrations/03_AddRecordDescription.hpp"
+#include "storage/migrations/04_AddTagColor.hpp"
+#include "storage/migrations/05_AddRecordSearch.hpp"
+#include "storage/migrations/06_AddDayStats.hpp"
+#include "storage/migrations/07_AddTagStats.hpp"
+#include "storage/migrations/08_AddTagNameIndex.hpp"
+#include "storage/migrations/09_StoreRecordDays.hpp"
+#include "storage/migrations/10_AddChangeTracking.hpp"
+#include "storage/migrations/11_AddImportCheckpoints.hpp"
+#include "storage/migrations/12_AddRecord2TagIndex.hpp"
+#include "storage/migrations/13_PinTagColors.hpp"
+#include "storage/migrations/14_CoalesceTagChanges.hpp"
+#include "storage/migrations/15_AddMovedRecords.hpp"
+#include "storage/migrations/16_DropUndatedDayStats.hpp"
 
 #include <QDebug>
+#include <QSqlError>
+#include <QSqlQuery>
 
 #include <Migrations/MigrationRepository.h>
 #include <QSqlMigrator/QSqlMigratorService.h>
@@ -27,12 +42,85 @@
 
 namespace tagberry::storage {
 
+namespace {
+
+template <class T> Migrations::Migration* makeMigration()
+{
+    return new T();
+}
+
+template <class T> SqlMigration* makeSqlMigration()
+{
+    return new T();
+}
+
+struct MigrationInfo {
+    const char* name;
+    Migrations::Migration* (*make)();
+};
+
+struct SqlMigrationInfo {
+    const char* name;
+    SqlMigration* (*make)();
+};
+
+// append only, schema fingerprint is computed from names
+const MigrationInfo migrationList[] = {
+    { "M01_CreateTables", &makeMigration<M01_CreateTables> },
+    { "M02_AddRecordState", &makeMigration<M02_AddRecordState> },
+    { "M03_AddRecordDescription", &makeMigration<M03_AddRecordDescription> },
+    { "M04_AddTagColor", &makeMigration<M04_AddTagColor> },
+};
+
+const SqlMigrationInfo sqlMigrationList[] = {
+    { "M05_AddRecordSearch", &makeSqlMigration<M05_AddRecordSearch> },
+    { "M06_AddDayStats", &makeSqlMigration<M06_AddDayStats> },
+    { "M07_AddTagStats", &makeSqlMigration<M07_AddTagStats> },
+    { "M08_AddTagNameIndex", &makeSqlMigration<M08_AddTagNameIndex> },
+    { "M09_StoreRecordDays", &makeSqlMigration<M09_StoreRecordDays> },
+    { "M10_AddChangeTracking", &makeSqlMigration<M10_AddChangeTracking> },
+    { "M11_AddImportCheckpoints", &makeSqlMigration<M11_AddImportCheckpoints> },
+    { "M12_AddRecord2TagIndex", &makeSqlMigration<M12_AddRecord2TagIndex> },
+    { "M13_PinTagColors", &makeSqlMigration<M13_PinTagColors> },
+    { "M14_CoalesceTagChanges", &makeSqlMigration<M14_CoalesceTagChanges> },
+    { "M15_AddMovedRecords", &makeSqlMigration<M15_AddMovedRecords> },
+    { "M16_DropUndatedDayStats", &makeSqlMigration<M16_DropUndatedDayStats> },
+};
+
+// FNV-1a over migration names, never zero, because zero is user_version
+// of a fresh database
+int schemaFingerprint()
+{
+    quint32 hash = 2166136261u;
+
+    // terminating zero is hashed too, to separate names
+    auto feed = [&](const char* name) {
+        for (auto p = name;; p++) {
+            hash ^= quint8(*p);
+            hash *= 16777619u;
+            if (!*p) {
+                break;
+            }
+        }
+    };
+
+    for (const auto& m : migrationList) {
+        feed(m.name);
+    }
+    for (const auto& m : sqlMigrationList) {
+        feed(m.name);
+    }
+
+    hash &= 0x7fffffff;
+
+    return hash ? int(hash) : 1;
+}
+
+} // namespace
+
 Migrator::Migrator(QSqlDatabase& db)
     : m_db(db)
 {
-    m_migrations.insert("M01_CreateTables", new M01_CreateTables());
-    m_migrations.insert("M02_AddRecordState", new M02_AddRecordState());
-    m_migrations.insert("M03_AddRecordDescription", new M03_AddRecordDescription());
 }
 
 Migrator::~Migrator()
@@ -40,12 +128,42 @@ Migrator::~Migrator()
     for (auto m : m_migrations) {
         delete m;
     }
+    for (auto m : m_sqlMigrations) {
+        delete m;
+    }
+}
+
+void Migrator::loadMigrations()
+{
+    if (!m_migrations.isEmpty()) {
+        return;
+    }
+
+    for (const auto& m : migrationList) {
+        m_migrations.insert(m.name, m.make());
+    }
+    for (const auto& m : sqlMigrationList) {
+        m_sqlMigrations.insert(m.name, m.make());
+    }
+}
+
+bool Migrator::isCurrent()
+{
+    QSqlQuery query(m_db);
+
+    if (!query.exec("PRAGMA user_version") || !query.next()) {
+        return false;
+    }
+
+    return query.value(0).toInt() == schemaFingerprint();
 }
 
 bool Migrator::migrate()
 {
     qDebug() << "applying migrations";
 
+    loadMigrations();
+
     auto contextBuilder
         = MigrationExecution::MigrationExecutionContext::Builder(m_migrations);
 
@@ -54,13 +172,75 @@ bool Migrator::migrate()
     auto context = SqliteMigrator::buildContext(contextBuilder);
 
     QSqlMigrator::QSqlMigratorService manager;
-    return manager.applyAll(*context);
+    if (!manager.applyAll(*context)) {
+        return false;
+    }
+
+    return applySqlMigrations();
+}
+
+bool Migrator::applySqlMigrations()
+{
+    QSqlQuery query(m_db);
+
+    if (!query.exec("CREATE TABLE IF NOT EXISTS sql_migrations"
+                    " (name NVARCHAR(100) PRIMARY KEY)")) {
+        qCritical() << "can't create sql_migrations table";
+        return false;
+    }
+
+    for (auto it = m_sqlMigrations.begin(); it != m_sqlMigrations.end(); ++it) {
+        query.prepare("SELECT name FROM sql_migrations WHERE name = (:name)");
+        query.bindValue(":name", it.key());
+
+        if (!query.exec()) {
+            qCritical() << "can't read sql_migrations table";
+            return false;
+        }
+
+        if (query.next()) {
+            continue;
+        }
+
+        qDebug() << "applying" << it.key();
+
+        m_db.transaction();
+
+        for (const auto& statement : it.value()->statements()) {
+            if (!query.exec(statement)) {
+                qCritical() << "can't apply" << it.key() << ":" << query.lastError().text();
+                m_db.rollback();
+                return false;
+            }
+        }
+
+        if (!it.value()->convert(m_db)) {
+            qCritical() << "can't apply" << it.key();
+            m_db.rollback();
+            return false;
+        }
+
+        query.prepare("INSERT INTO sql_migrations (name) VALUES (:name)");
+        query.bindValue(":name", it.key());
+
+        if (!query.exec()) {
+            qCritical() << "can't write sql_migrations table";
+            m_db.rollback();
+            return false;
+        }
+
+        m_db.commit();
+    }
+
+    return true;
 }
 
 bool Migrator::validate()
 {
     qDebug() << "validating schema";
 
+    loadMigrations();
+
     LocalSchemePtr localScheme(new Structure::LocalScheme);
 
     auto localContext
@@ -88,4 +268,16 @@ bool Migrator::validate()
     return comparisonService.compareLocalSchemeWithDatabase(comparisonContext);
 }
 
+bool Migrator::stampFingerprint()
+{
+    QSqlQuery query(m_db);
+
+    if (!query.exec(QString("PRAGMA user_version = %1").arg(schemaFingerprint()))) {
+        qCritical() << "can't write schema version";
+        return false;
+    }
+
+    return true;
+}
+
 } // namespace tagberry::storage
@@ -9,8 +9,11 @@
 
 #pragma once
 
+#include "storage/SqlMigration.hpp"
+
 #include <Migrations/MigrationRepository.h>
 
+#include <QMap>
 #include <QSqlDatabase>
 
 namespace tagberry::storage {
@@ -20,11 +23,26 @@ public:
     Migrator(QSqlDatabase&);
     ~Migrator();
 
+    // Cheap check that doesn't touch QSqlMigrator: compares fingerprint
+    // of known migrations with the one stored in PRAGMA user_version by
+    // stampFingerprint().
+    bool isCurrent();
+
     bool migrate();
     bool validate();
 
+    // marks schema as current, to be called once migrated schema is
+    // validated, so that invalid one is validated again on next open
+    bool stampFingerprint();
+
 private:
+    // migrations are instantiated only when going to migrate or validate
+    void loadMigrations();
+
+    bool applySqlMigrations();
+
     Migrations::MigrationRepository::NameMigrationMap m_migrations;
+    QMap<QString, SqlMigration*> m_sqlMigrations;
     QSqlDatabase m_db;
 };
 
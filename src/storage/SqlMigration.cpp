@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/SqlMigration.hpp"
+
+namespace tagberry::storage {
+
+const QStringList& SqlMigration::statements() const
+{
+    return m_statements;
+}
+
+bool SqlMigration::convert(QSqlDatabase&)
+{
+    return true;
+}
+
+void SqlMigration::add(const QString& statement)
+{
+    m_statements.append(statement);
+}
+
+} // namespace tagberry::storage
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+
+namespace tagberry::storage {
+
+// Migration written as plain SQL, for things QSqlMigrator can't express,
+// like virtual tables, triggers and data conversion. Applied by Migrator
+// after QSqlMigrator migrations, each one in its own transaction.
+class SqlMigration {
+public:
+    virtual ~SqlMigration() = default;
+
+    const QStringList& statements() const;
+
+    // conversion that can't be written in SQL, run after statements in
+    // the same transaction
+    virtual bool convert(QSqlDatabase& db);
+
+protected:
+    void add(const QString& statement);
+
+private:
+    QStringList m_statements;
+};
+
+} // namespace tagberry::storage
@@ -0,0 +1,27 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/migrations/04_AddTagColor.hpp"
+
+// QSqlMigrator
+#include <api.h>
+
+using namespace Commands;
+using namespace Structure;
+
+namespace tagberry::storage {
+
+M04_AddTagColor::M04_AddTagColor()
+{
+    auto col = Column("color", Type("INTEGER"));
+
+    add(new AddColumn(col, "tags"));
+}
+
+} // namespace tagberry::storage
@@ -0,0 +1,21 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <Migrations/Migration.h>
+
+namespace tagberry::storage {
+
+class M04_AddTagColor : public Migrations::Migration {
+public:
+    M04_AddTagColor();
+};
+
+} // namespace tagberry::storage
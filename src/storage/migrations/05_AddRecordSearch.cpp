@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/migrations/05_AddRecordSearch.hpp"
+
+namespace tagberry::storage {
+
+M05_AddRecordSearch::M05_AddRecordSearch()
+{
+    // external content table, text itself stays in records;
+    // short prefixes are indexed to keep search-as-you-type fast
+    add("CREATE VIRTUAL TABLE records_fts USING fts5("
+        " title, description,"
+        " content = 'records', content_rowid = 'id',"
+        " prefix = '2 3')");
+
+    add("CREATE TRIGGER records_fts_insert AFTER INSERT ON records BEGIN"
+        " INSERT INTO records_fts (rowid, title, description)"
+        "  VALUES (new.id, new.title, new.description);"
+        " END");
+
+    add("CREATE TRIGGER records_fts_delete AFTER DELETE ON records BEGIN"
+        " INSERT INTO records_fts (records_fts, rowid, title, description)"
+        "  VALUES ('delete', old.id, old.title, old.description);"
+        " END");
+
+    // saveRecord rewrites all columns, so skip reindexing when text is the same
+    add("CREATE TRIGGER records_fts_update AFTER UPDATE OF title, description ON records"
+        " WHEN old.title IS NOT new.title OR old.description IS NOT new.description"
+        " BEGIN"
+        " INSERT INTO records_fts (records_fts, rowid, title, description)"
+        "  VALUES ('delete', old.id, old.title, old.description);"
+        " INSERT INTO records_fts (rowid, title, description)"
+        "  VALUES (new.id, new.title, new.description);"
+        " END");
+
+    add("INSERT INTO records_fts (records_fts) VALUES ('rebuild')");
+}
+
+} // namespace tagberry::storage
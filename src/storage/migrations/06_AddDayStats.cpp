@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/migrations/06_AddDayStats.hpp"
+
+namespace tagberry::storage {
+
+M06_AddDayStats::M06_AddDayStats()
+{
+    // per-day record counters, tag 0 counts all records of the day;
+    // day is julian day number, as in QDate::toJulianDay()
+    add("CREATE TABLE day_stats ("
+        " day INTEGER NOT NULL,"
+        " tag INTEGER NOT NULL,"
+        " total INTEGER NOT NULL,"
+        " complete INTEGER NOT NULL,"
+        " PRIMARY KEY (tag, day))");
+
+    // records.date is local midnight in unix time, or (uint)-1 if not set;
+    // records without date are not counted
+    add("INSERT INTO day_stats (day, tag, total, complete)"
+        " SELECT CAST(julianday(date(date, 'unixepoch', 'localtime')) + 0.5 AS INTEGER),"
+        "  0, COUNT(*), SUM(state = 1)"
+        " FROM records WHERE date IS NOT NULL AND date NOT IN (-1, 4294967295)"
+        " GROUP BY 1");
+
+    add("INSERT INTO day_stats (day, tag, total, complete)"
+        " SELECT CAST(julianday(date(records.date, 'unixepoch', 'localtime')) + 0.5"
+        "  AS INTEGER), record2tag.tag, COUNT(*), SUM(records.state = 1)"
+        " FROM records INNER JOIN record2tag ON record2tag.record = records.id"
+        " WHERE records.date IS NOT NULL AND records.date NOT IN (-1, 4294967295)"
+        " GROUP BY 1, 2");
+}
+
+} // namespace tagberry::storage
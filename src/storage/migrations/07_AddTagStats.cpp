@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/migrations/07_AddTagStats.hpp"
+
+namespace tagberry::storage {
+
+M07_AddTagStats::M07_AddTagStats()
+{
+    // per-tag usage counters, last_used is julian day number
+    add("CREATE TABLE tag_stats ("
+        " tag INTEGER PRIMARY KEY,"
+        " total INTEGER NOT NULL,"
+        " open INTEGER NOT NULL,"
+        " last_used INTEGER)");
+
+    // day_stats already has per-tag counters
+    add("INSERT INTO tag_stats (tag, total, open, last_used)"
+        " SELECT tag, SUM(total), SUM(total - complete), MAX(day)"
+        " FROM day_stats WHERE tag != 0 GROUP BY tag");
+}
+
+} // namespace tagberry::storage
@@ -0,0 +1,20 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/migrations/08_AddTagNameIndex.hpp"
+
+namespace tagberry::storage {
+
+M08_AddTagNameIndex::M08_AddTagNameIndex()
+{
+    // tags are loaded on demand, by name too
+    add("CREATE INDEX tags_name ON tags (name)");
+}
+
+} // namespace tagberry::storage
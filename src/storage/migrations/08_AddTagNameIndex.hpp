@@ -0,0 +1,21 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "storage/SqlMigration.hpp"
+
+namespace tagberry::storage {
+
+class M08_AddTagNameIndex : public SqlMigration {
+public:
+    M08_AddTagNameIndex();
+};
+
+} // namespace tagberry::storage
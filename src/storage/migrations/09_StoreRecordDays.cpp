@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/migrations/09_StoreRecordDays.hpp"
+
+namespace tagberry::storage {
+
+M09_StoreRecordDays::M09_StoreRecordDays()
+{
+    // records.date was local midnight in unix time, now it's julian day
+    // number, as in QDate::toJulianDay(); records without date were
+    // stored as (uint)-1 and become NULL
+    add("UPDATE records SET date = CASE"
+        " WHEN date IS NULL OR date = -1 OR date = 4294967295 THEN NULL"
+        " ELSE CAST(julianday(date(date, 'unixepoch', 'localtime')) + 0.5 AS INTEGER)"
+        " END");
+
+    // pages are read by date range
+    add("CREATE INDEX records_date ON records (date)");
+}
+
+} // namespace tagberry::storage
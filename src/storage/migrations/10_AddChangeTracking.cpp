@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/migrations/10_AddChangeTracking.hpp"
+
+namespace tagberry::storage {
+
+M10_AddChangeTracking::M10_AddChangeTracking()
+{
+    // every write to records or record2tag, by any process, takes next
+    // counter value; rows written before have 0
+    add("CREATE TABLE change_counter (value INTEGER NOT NULL)");
+    add("INSERT INTO change_counter (value) VALUES (0)");
+
+    add("ALTER TABLE records ADD COLUMN updated_at INTEGER NOT NULL DEFAULT 0");
+    add("CREATE INDEX records_updated_at ON records (updated_at)");
+
+    // tombstones of removed records
+    add("CREATE TABLE deleted_records ("
+        " id INTEGER PRIMARY KEY,"
+        " date INTEGER,"
+        " updated_at INTEGER NOT NULL)");
+    add("CREATE INDEX deleted_records_updated_at ON deleted_records (updated_at)");
+
+    // updated_at itself is not in column lists, so triggers don't recurse
+    add("CREATE TRIGGER records_changed_insert AFTER INSERT ON records BEGIN"
+        " UPDATE change_counter SET value = value + 1;"
+        " UPDATE records SET updated_at = (SELECT value FROM change_counter)"
+        "  WHERE id = new.id;"
+        " END");
+
+    add("CREATE TRIGGER records_changed_update"
+        " AFTER UPDATE OF date, state, title, description ON records BEGIN"
+        " UPDATE change_counter SET value = value + 1;"
+        " UPDATE records SET updated_at = (SELECT value FROM change_counter)"
+        "  WHERE id = new.id;"
+        " END");
+
+    add("CREATE TRIGGER records_changed_delete AFTER DELETE ON records BEGIN"
+        " UPDATE change_counter SET value = value + 1;"
+        " INSERT OR REPLACE INTO deleted_records (id, date, updated_at)"
+        "  VALUES (old.id, old.date, (SELECT value FROM change_counter));"
+        " END");
+
+    add("CREATE TRIGGER record2tag_changed_insert AFTER INSERT ON record2tag BEGIN"
+        " UPDATE change_counter SET value = value + 1;"
+        " UPDATE records SET updated_at = (SELECT value FROM change_counter)"
+        "  WHERE id = new.record;"
+        " END");
+
+    add("CREATE TRIGGER record2tag_changed_delete AFTER DELETE ON record2tag BEGIN"
+        " UPDATE change_counter SET value = value + 1;"
+        " UPDATE records SET updated_at = (SELECT value FROM change_counter)"
+        "  WHERE id = old.record;"
+        " END");
+}
+
+} // namespace tagberry::storage
@@ -0,0 +1,26 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/migrations/11_AddImportCheckpoints.hpp"
+
+namespace tagberry::storage {
+
+M11_AddImportCheckpoints::M11_AddImportCheckpoints()
+{
+    // progress of imported files, written with each committed chunk;
+    // position is byte offset of first not imported record, day is
+    // julian day in effect there (for markdown journals)
+    add("CREATE TABLE import_checkpoints ("
+        " source TEXT PRIMARY KEY,"
+        " position INTEGER NOT NULL,"
+        " records INTEGER NOT NULL,"
+        " day INTEGER)");
+}
+
+} // namespace tagberry::storage
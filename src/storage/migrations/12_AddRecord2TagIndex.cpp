@@ -0,0 +1,21 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/migrations/12_AddRecord2TagIndex.hpp"
+
+namespace tagberry::storage {
+
+M12_AddRecord2TagIndex::M12_AddRecord2TagIndex()
+{
+    // tags of a record are read per record, records of a tag by filters
+    add("CREATE INDEX record2tag_record ON record2tag (record)");
+    add("CREATE INDEX record2tag_tag ON record2tag (tag)");
+}
+
+} // namespace tagberry::storage
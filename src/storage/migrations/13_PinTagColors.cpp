@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/migrations/13_PinTagColors.hpp"
+#include "models/ColorScheme.hpp"
+
+#include <QDebug>
+#include <QList>
+#include <QPair>
+#include <QSqlQuery>
+
+namespace tagberry::storage {
+
+// tags created before tags.color column keep colors they were shown with;
+// tags created later store their index on insert
+bool M13_PinTagColors::convert(QSqlDatabase& db)
+{
+    const models::ColorScheme colorScheme;
+
+    QSqlQuery query(db);
+
+    if (!query.exec("SELECT id, name FROM tags WHERE color IS NULL")) {
+        qCritical() << "can't read tags without color";
+        return false;
+    }
+
+    QList<QPair<quint32, int>> colors;
+
+    while (query.next()) {
+        colors.append(qMakePair(query.value(0).toUInt(),
+            colorScheme.legacyTagIndex(query.value(1).toString())));
+    }
+
+    qDebug() << "pinning colors of" << colors.size() << "tags";
+
+    query.prepare("UPDATE tags SET color = (:color) WHERE id = (:id)");
+
+    for (const auto& color : colors) {
+        query.bindValue(":id", color.first);
+        query.bindValue(":color", color.second);
+
+        if (!query.exec()) {
+            qCritical() << "can't pin tag color";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace tagberry::storage
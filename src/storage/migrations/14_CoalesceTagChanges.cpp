@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/migrations/14_CoalesceTagChanges.hpp"
+
+namespace tagberry::storage {
+
+M14_CoalesceTagChanges::M14_CoalesceTagChanges()
+{
+    // record already holding latest counter value needs no new one; this
+    // halves the cost of inserting tagged records, because tags are written
+    // right after their record; readers must then compare updated_at with >=,
+    // since record may be stamped again with the value they have seen
+    add("DROP TRIGGER record2tag_changed_insert");
+    add("DROP TRIGGER record2tag_changed_delete");
+
+    add("CREATE TRIGGER record2tag_changed_insert AFTER INSERT ON record2tag"
+        " WHEN (SELECT updated_at FROM records WHERE id = new.record)"
+        "  < (SELECT value FROM change_counter) BEGIN"
+        " UPDATE change_counter SET value = value + 1;"
+        " UPDATE records SET updated_at = (SELECT value FROM change_counter)"
+        "  WHERE id = new.record;"
+        " END");
+
+    add("CREATE TRIGGER record2tag_changed_delete AFTER DELETE ON record2tag"
+        " WHEN (SELECT updated_at FROM records WHERE id = old.record)"
+        "  < (SELECT value FROM change_counter) BEGIN"
+        " UPDATE change_counter SET value = value + 1;"
+        " UPDATE records SET updated_at = (SELECT value FROM change_counter)"
+        "  WHERE id = old.record;"
+        " END");
+
+    // so that rows written before change tracking are never at latest value
+    add("UPDATE change_counter SET value = value + 1");
+}
+
+} // namespace tagberry::storage
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/migrations/15_AddMovedRecords.hpp"
+
+namespace tagberry::storage {
+
+M15_AddMovedRecords::M15_AddMovedRecords()
+{
+    // previous days of records moved to another day, so that stats of
+    // both days can be recomputed after external changes
+    add("CREATE TABLE moved_records ("
+        " date INTEGER NOT NULL,"
+        " updated_at INTEGER NOT NULL)");
+    add("CREATE INDEX moved_records_updated_at ON moved_records (updated_at)");
+
+    add("DROP TRIGGER records_changed_update");
+
+    // insert is empty unless date was changed
+    add("CREATE TRIGGER records_changed_update"
+        " AFTER UPDATE OF date, state, title, description ON records BEGIN"
+        " UPDATE change_counter SET value = value + 1;"
+        " UPDATE records SET updated_at = (SELECT value FROM change_counter)"
+        "  WHERE id = new.id;"
+        " INSERT INTO moved_records (date, updated_at)"
+        "  SELECT old.date, value FROM change_counter"
+        "  WHERE old.date IS NOT NULL AND old.date IS NOT new.date;"
+        " END");
+
+    // recomputed and cleaned up per day
+    add("CREATE INDEX day_stats_day ON day_stats (day)");
+}
+
+} // namespace tagberry::storage
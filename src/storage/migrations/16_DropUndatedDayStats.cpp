@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "storage/migrations/16_DropUndatedDayStats.hpp"
+
+namespace tagberry::storage {
+
+namespace {
+
+// days M06 counted records without date on, when they were (uint)-1
+const QString undatedDays
+    = "SELECT CAST(julianday(date(value, 'unixepoch', 'localtime')) + 0.5 AS INTEGER)"
+      " FROM (SELECT -1 AS value UNION SELECT 4294967295)";
+
+} // namespace
+
+M16_DropUndatedDayStats::M16_DropUndatedDayStats()
+{
+    // counters of these days are recomputed from records, which are
+    // julian days since M09 and NULL if not set
+    add("DELETE FROM day_stats WHERE day IN (" + undatedDays + ")");
+
+    add("INSERT INTO day_stats (day, tag, total, complete)"
+        " SELECT date, 0, COUNT(*), SUM(state = 1)"
+        " FROM records WHERE date IN ("
+        + undatedDays + ") GROUP BY date");
+
+    add("INSERT INTO day_stats (day, tag, total, complete)"
+        " SELECT records.date, record2tag.tag, COUNT(*), SUM(records.state = 1)"
+        " FROM records INNER JOIN record2tag ON record2tag.record = records.id"
+        " WHERE records.date IN ("
+        + undatedDays + ") GROUP BY records.date, record2tag.tag");
+
+    // M07 copied wrong counters and last_used to every tag of such records
+    add("DELETE FROM tag_stats");
+
+    add("INSERT INTO tag_stats (tag, total, open, last_used)"
+        " SELECT tag, SUM(total), SUM(total - complete), MAX(day)"
+        " FROM day_stats WHERE tag != 0 GROUP BY tag");
+}
+
+} // namespace tagberry::storage
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "trace/Trace.hpp"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QThread>
+
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace tagberry::trace {
+
+namespace {
+
+struct Event {
+    const char* name;
+    qint64 begin;
+    qint64 end;
+    quintptr thread;
+};
+
+struct Phase {
+    const char* name;
+    qint64 end;
+};
+
+struct State {
+    QString path;
+    QElapsedTimer timer;
+
+    std::mutex mutex;
+    std::vector<Event> events;
+
+    QElapsedTimer startupTimer;
+    std::vector<Phase> phases;
+};
+
+State& state()
+{
+    static State s;
+    return s;
+}
+
+} // namespace
+
+namespace detail {
+
+bool enabled = false;
+
+qint64 now()
+{
+    return state().timer.nsecsElapsed();
+}
+
+void addSpan(const char* name, qint64 begin, qint64 end)
+{
+    auto& s = state();
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    s.events.push_back(
+        Event { name, begin, end, quintptr(QThread::currentThreadId()) });
+}
+
+} // namespace detail
+
+bool start(const QString& path)
+{
+    auto& s = state();
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCritical() << "can't open trace file" << path;
+        return false;
+    }
+
+    s.path = path;
+    s.events.reserve(1 << 16);
+    s.timer.start();
+
+    detail::enabled = true;
+
+    return true;
+}
+
+bool stop()
+{
+    auto& s = state();
+
+    if (!detail::enabled) {
+        return true;
+    }
+
+    detail::enabled = false;
+
+    QFile file(s.path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCritical() << "can't open trace file" << s.path;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    // complete events ("ph": "X"), timestamps in microseconds
+    const auto pid = QCoreApplication::applicationPid();
+
+    file.write("{\"traceEvents\":[\n");
+
+    for (size_t n = 0; n < s.events.size(); n++) {
+        const auto& e = s.events[n];
+
+        file.write(QString("{\"name\":\"%1\",\"ph\":\"X\",\"pid\":%2,\"tid\":%3,"
+                           "\"ts\":%4,\"dur\":%5}%6\n")
+                       .arg(QLatin1String(e.name))
+                       .arg(pid)
+                       .arg(e.thread)
+                       .arg(double(e.begin) / 1000, 0, 'f', 3)
+                       .arg(double(e.end - e.begin) / 1000, 0, 'f', 3)
+                       .arg(n + 1 < s.events.size() ? "," : "")
+                       .toUtf8());
+    }
+
+    file.write("],\"displayTimeUnit\":\"ms\"}\n");
+
+    qDebug() << "written" << s.events.size() << "trace events to" << s.path;
+
+    s.events.clear();
+
+    return true;
+}
+
+void beginStartup()
+{
+    state().startupTimer.start();
+}
+
+void markPhase(const char* name)
+{
+    auto& s = state();
+
+    if (s.startupTimer.isValid()) {
+        s.phases.push_back(Phase { name, s.startupTimer.nsecsElapsed() });
+    }
+}
+
+void printStartupProfile()
+{
+    const auto& s = state();
+
+    std::cerr << "startup profile:\n";
+
+    qint64 begin = 0;
+
+    for (const auto& phase : s.phases) {
+        std::cerr << "  " << std::left << std::setw(24) << phase.name << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(9)
+                  << double(phase.end - begin) / 1e6 << " ms" << std::setw(9)
+                  << double(phase.end) / 1e6 << " ms total\n";
+        begin = phase.end;
+    }
+}
+
+} // namespace tagberry::trace
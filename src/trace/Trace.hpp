@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+namespace tagberry::trace {
+
+// Starts recording spans; they are written to path in Chrome trace
+// format (chrome://tracing, ui.perfetto.dev) by stop().
+bool start(const QString& path);
+bool stop();
+
+// Wall time of startup phases: markPhase() ends current phase and starts
+// next one, first phase starts at beginStartup().
+void beginStartup();
+void markPhase(const char* name);
+void printStartupProfile();
+
+namespace detail {
+
+// checked inline, so that disabled spans cost one load and branch
+extern bool enabled;
+
+qint64 now();
+void addSpan(const char* name, qint64 begin, qint64 end);
+
+} // namespace detail
+
+class Span {
+public:
+    explicit Span(const char* name)
+        : m_name(detail::enabled ? name : nullptr)
+        , m_begin(m_name ? detail::now() : 0)
+    {
+    }
+
+    ~Span()
+    {
+        if (m_name) {
+            detail::addSpan(m_name, m_begin, detail::now());
+        }
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* m_name;
+    qint64 m_begin;
+};
+
+} // namespace tagberry::trace
+
+#define TRACE_SPAN_CONCAT_(a, b) a##b
+#define TRACE_SPAN_NAME_(line) TRACE_SPAN_CONCAT_(traceSpan_, line)
+
+// records duration of enclosing scope; name must be a string literal
+#define TRACE_SPAN(name) ::tagberry::trace::Span TRACE_SPAN_NAME_(__LINE__)(name)
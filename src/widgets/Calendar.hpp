@@ -54,10 +54,10 @@ public slots:
     void setFocus(CalendarCell*);
 
     void setToday();
+    void setDate(const QDate&);
 
 private slots:
     void setPage(int year, int month);
-    void setDate(const QDate&);
 
 private:
     enum { NumDays = 7, NumWeeks = 5 };
@@ -39,6 +39,7 @@
 ****************************************************************************/
 
 #include "widgets/FlowLayout.hpp"
+#include "trace/Trace.hpp"
 
 #include <QtWidgets>
 
@@ -158,6 +159,8 @@ void FlowLayout::setPreferredWidth(int w)
 
 int FlowLayout::doLayout(const QRect& rect, bool testOnly) const
 {
+    TRACE_SPAN("FlowLayout::doLayout");
+
     int left, top, right, bottom;
     getContentsMargins(&left, &top, &right, &bottom);
     QRect effectiveRect = rect.adjusted(+left, +top, -right, -bottom);
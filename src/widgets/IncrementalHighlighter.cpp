@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "widgets/IncrementalHighlighter.hpp"
+#include "trace/Trace.hpp"
+
+#include <QElapsedTimer>
+#include <QTextBlock>
+
+#include <qmarkdowntextedit.h>
+
+namespace tagberry::widgets {
+
+namespace {
+
+// keeps a slice well below one frame
+const qint64 sliceBudgetMs = 4;
+
+} // namespace
+
+IncrementalHighlighter::IncrementalHighlighter(QMarkdownTextEdit* edit)
+    : MarkdownHighlighter(edit->document())
+    , m_edit(edit)
+{
+    m_sliceTimer.setSingleShot(true);
+    m_sliceTimer.setInterval(0);
+
+    connect(&m_sliceTimer, &QTimer::timeout, this,
+        &IncrementalHighlighter::highlightSlice);
+}
+
+void IncrementalHighlighter::setText(const QString& text)
+{
+    // text change would highlight every block in place, so hold it back
+    m_gated = true;
+    m_targetBlock = -1;
+
+    clearDirtyBlocks();
+    m_edit->setText(text);
+
+    m_gated = false;
+
+    rehighlightIncrementally();
+}
+
+void IncrementalHighlighter::rehighlightIncrementally()
+{
+    highlightVisible();
+
+    // visible blocks could be highlighted with wrong state of previous
+    // ones, so background pass still goes through all blocks in order
+    m_nextBlock = 0;
+    m_sliceTimer.start();
+}
+
+void IncrementalHighlighter::highlightBlock(const QString& text)
+{
+    if (m_gated && currentBlock().blockNumber() != m_targetBlock) {
+        return;
+    }
+    MarkdownHighlighter::highlightBlock(text);
+}
+
+void IncrementalHighlighter::highlightVisible()
+{
+    auto rect = m_edit->viewport()->visibleRegion().boundingRect();
+    if (rect.isEmpty()) {
+        return;
+    }
+
+    auto block = m_edit->cursorForPosition(rect.topLeft()).block();
+    auto last = m_edit->cursorForPosition(rect.bottomLeft()).block();
+
+    for (; block.isValid(); block = block.next()) {
+        highlightOne(block);
+        if (block == last) {
+            break;
+        }
+    }
+}
+
+void IncrementalHighlighter::highlightSlice()
+{
+    TRACE_SPAN("IncrementalHighlighter::highlightSlice");
+
+    if (m_nextBlock < 0) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    auto block = document()->findBlockByNumber(m_nextBlock);
+
+    for (; block.isValid(); block = block.next()) {
+        if (timer.elapsed() >= sliceBudgetMs) {
+            m_nextBlock = block.blockNumber();
+            m_sliceTimer.start();
+            return;
+        }
+        highlightOne(block);
+    }
+
+    m_nextBlock = -1;
+}
+
+void IncrementalHighlighter::highlightOne(const QTextBlock& block)
+{
+    // without gate, changed block state would cascade to all next blocks
+    m_gated = true;
+    m_targetBlock = block.blockNumber();
+
+    rehighlightBlock(block);
+
+    m_gated = false;
+    m_targetBlock = -1;
+}
+
+} // namespace tagberry::widgets
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QTimer>
+
+#include <markdownhighlighter.h>
+
+class QMarkdownTextEdit;
+
+namespace tagberry::widgets {
+
+// Markdown highlighter that doesn't block on whole document. Visible blocks
+// are highlighted at once, the rest in short slices from event loop.
+class IncrementalHighlighter : public MarkdownHighlighter {
+    Q_OBJECT
+
+public:
+    explicit IncrementalHighlighter(QMarkdownTextEdit* edit);
+
+    // replaces text without highlighting it synchronously
+    void setText(const QString& text);
+
+    // starts re-highlighting of whole document, e.g. after format change
+    void rehighlightIncrementally();
+
+protected:
+    void highlightBlock(const QString& text) override;
+
+private:
+    void highlightVisible();
+    void highlightSlice();
+    void highlightOne(const QTextBlock& block);
+
+    QMarkdownTextEdit* m_edit;
+    QTimer m_sliceTimer;
+
+    // block to highlight next in background, -1 when done
+    int m_nextBlock { -1 };
+
+    // when set, only m_targetBlock is highlighted
+    bool m_gated {};
+    int m_targetBlock { -1 };
+};
+
+} // namespace tagberry::widgets
@@ -8,6 +8,7 @@
  */
 
 #include "widgets/LineEdit.hpp"
+#include "trace/Trace.hpp"
 
 #include <QApplication>
 #include <QCommonStyle>
@@ -126,6 +127,8 @@ bool LineEdit::eventFilter(QObject* obj, QEvent* event)
 
 void LineEdit::paintEvent(QPaintEvent* event)
 {
+    TRACE_SPAN("LineEdit::paintEvent");
+
     if (m_firstPaint) {
         m_firstPaint = false;
         updateText();
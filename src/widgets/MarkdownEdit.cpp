@@ -8,7 +8,10 @@
  */
 
 #include "widgets/MarkdownEdit.hpp"
+#include "trace/Trace.hpp"
+#include "widgets/IncrementalHighlighter.hpp"
 
+#include <QAbstractTextDocumentLayout>
 #include <QApplication>
 #include <QDebug>
 #include <QFontMetrics>
@@ -17,228 +20,14 @@
 
 namespace tagberry::widgets {
 
-namespace {
-
-QHash<MarkdownHighlighter::HighlighterState, QTextCharFormat> createFormatMap(
-    const QHash<QString, QColor>& colorMap, int fontSize)
-{
-    QHash<MarkdownHighlighter::HighlighterState, QTextCharFormat> formatMap;
-
-    // empty
-    {
-        auto format = QTextCharFormat();
-        formatMap[MarkdownHighlighter::NoState] = format;
-    }
-
-    // headline end
-    {
-        auto format = QTextCharFormat();
-        formatMap[MarkdownHighlighter::HeadlineEnd] = format;
-    }
-
-    // headlines
-    {
-        auto format = QTextCharFormat();
-        format.setFontWeight(QFont::Bold);
-        format.setForeground(QBrush(colorMap["text-light"]));
-
-        format.setFontPointSize(fontSize * 1.4);
-        formatMap[MarkdownHighlighter::H1] = format;
-
-        format.setFontPointSize(fontSize * 1.3);
-        formatMap[MarkdownHighlighter::H2] = format;
-
-        format.setFontPointSize(fontSize * 1.2);
-        formatMap[MarkdownHighlighter::H3] = format;
-
-        format.setFontPointSize(fontSize * 1.1);
-        formatMap[MarkdownHighlighter::H4] = format;
-
-        format.setFontPointSize(fontSize * 1.0);
-        formatMap[MarkdownHighlighter::H5] = format;
-
-        format.setFontPointSize(fontSize * 1.0);
-        formatMap[MarkdownHighlighter::H6] = format;
-    }
-
-    // horizontal ruler
-    {
-        auto format = QTextCharFormat();
-        format.setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
-        format.setFontWeight(QFont::Bold);
-        format.setForeground(QBrush(colorMap["text-extra-light"]));
-
-        formatMap[MarkdownHighlighter::HorizontalRuler] = format;
-    }
-
-    // list
-    {
-        auto format = QTextCharFormat();
-        format.setFontWeight(QFont::Bold);
-        format.setForeground(QBrush(colorMap["text-extra-light"]));
-
-        formatMap[MarkdownHighlighter::List] = format;
-    }
-
-    // link
-    {
-        auto format = QTextCharFormat();
-        format.setFontUnderline(true);
-        format.setForeground(QBrush(colorMap["text-url"]));
-
-        formatMap[MarkdownHighlighter::Link] = format;
-    }
-
-    // image
-    {
-        auto format = QTextCharFormat();
-        format.setFontWeight(QFont::Bold);
-        format.setForeground(QBrush(colorMap["text-light"]));
-
-        formatMap[MarkdownHighlighter::Image] = format;
-    }
-
-    // italic
-    {
-        auto format = QTextCharFormat();
-        format.setFontWeight(QFont::StyleItalic);
-        format.setFontItalic(true);
-
-        formatMap[MarkdownHighlighter::Italic] = format;
-    }
-
-    // bold
-    {
-        auto format = QTextCharFormat();
-        format.setFontWeight(QFont::Bold);
-        format.setForeground(QBrush(colorMap["text-light"]));
-
-        formatMap[MarkdownHighlighter::Bold] = format;
-    }
-
-    // comment
-    {
-        auto format = QTextCharFormat();
-        format.setForeground(QBrush(colorMap["text-extra-light"]));
-
-        formatMap[MarkdownHighlighter::Comment] = format;
-    }
-
-    // masked syntax
-    {
-        auto format = QTextCharFormat();
-        format.setForeground(QBrush(colorMap["text-extra-light"]));
-
-        formatMap[MarkdownHighlighter::MaskedSyntax] = format;
-    }
-
-    // table
-    {
-        auto format = QTextCharFormat();
-        format.setFont(QFont("monospace", fontSize - 1));
-        format.setForeground(QBrush(colorMap["text-light"]));
-
-        formatMap[MarkdownHighlighter::Table] = format;
-    }
-
-    // block quote
-    {
-        auto format = QTextCharFormat();
-        format.setFontWeight(QFont::Bold);
-        format.setForeground(QBrush(colorMap["text-extra-light"]));
-
-        formatMap[MarkdownHighlighter::BlockQuote] = format;
-    }
-
-    // code block
-    {
-        auto format = QTextCharFormat();
-        format.setFont(QFont("monospace", fontSize - 1));
-        format.setBackground(QBrush(colorMap["code-background"]));
-
-        formatMap[MarkdownHighlighter::CodeBlock] = format;
-        formatMap[MarkdownHighlighter::InlineCodeBlock] = format;
-    }
-
-    // code keyword
-    {
-        auto format = QTextCharFormat();
-        format.setFont(QFont("monospace", fontSize - 1));
-        format.setBackground(QBrush(colorMap["code-background"]));
-        format.setForeground(QBrush(colorMap["code-keyword"]));
-
-        formatMap[MarkdownHighlighter::CodeKeyWord] = format;
-    }
-
-    // code type
-    {
-        auto format = QTextCharFormat();
-        format.setFont(QFont("monospace", fontSize - 1));
-        format.setBackground(QBrush(colorMap["code-background"]));
-        format.setForeground(QBrush(colorMap["code-type"]));
-
-        formatMap[MarkdownHighlighter::CodeType] = format;
-    }
-
-    // code built-in
-    {
-        auto format = QTextCharFormat();
-        format.setFont(QFont("monospace", fontSize - 1));
-        format.setBackground(QBrush(colorMap["code-background"]));
-        format.setForeground(QBrush(colorMap["code-builtin"]));
-
-        formatMap[MarkdownHighlighter::CodeBuiltIn] = format;
-    }
-
-    // code string
-    {
-        auto format = QTextCharFormat();
-        format.setFont(QFont("monospace", fontSize - 1));
-        format.setBackground(QBrush(colorMap["code-background"]));
-        format.setForeground(QBrush(colorMap["code-string"]));
-
-        formatMap[MarkdownHighlighter::CodeString] = format;
-    }
-
-    // code number
-    {
-        auto format = QTextCharFormat();
-        format.setFont(QFont("monospace", fontSize - 1));
-        format.setBackground(QBrush(colorMap["code-background"]));
-        format.setForeground(QBrush(colorMap["code-number"]));
-
-        formatMap[MarkdownHighlighter::CodeNumLiteral] = format;
-    }
-
-    // code comment
-    {
-        auto format = QTextCharFormat();
-        format.setFont(QFont("monospace", fontSize - 1));
-        format.setBackground(QBrush(colorMap["code-background"]));
-        format.setForeground(QBrush(colorMap["code-comment"]));
-
-        formatMap[MarkdownHighlighter::CodeComment] = format;
-    }
-
-    // code other
-    {
-        auto format = QTextCharFormat();
-        format.setFont(QFont("monospace", fontSize - 1));
-        format.setBackground(QBrush(colorMap["code-background"]));
-        format.setForeground(QBrush(colorMap["code-other"]));
-
-        formatMap[MarkdownHighlighter::CodeOther] = format;
-    }
-
-    return formatMap;
-}
-
-} // namespace
-
 MarkdownEdit::MarkdownEdit(QWidget* parent)
     : QWidget(parent)
     , m_edit(new QMarkdownTextEdit)
 {
+    // built-in highlighter would highlight whole text at once on setText()
+    m_edit->highlighter()->setDocument(nullptr);
+    m_highlighter = new IncrementalHighlighter(m_edit);
+
     setLayout(&m_layout);
 
     m_layout.setContentsMargins(QMargins(m_hMargin, m_vMargin, m_hMargin, m_vMargin));
@@ -252,11 +41,23 @@ MarkdownEdit::MarkdownEdit(QWidget* parent)
     font.setPointSize(m_fontSize);
     m_edit->setFont(font);
 
+    // relayouts come in bursts while typing, apply them once per frame
+    m_heightTimer.setSingleShot(true);
+    m_heightTimer.setInterval(16);
+
+    connect(&m_heightTimer, &QTimer::timeout, this, &MarkdownEdit::updateHeight);
+
+    auto docLayout = m_edit->document()->documentLayout();
+
+    connect(docLayout, &QAbstractTextDocumentLayout::documentSizeChanged, this,
+        &MarkdownEdit::scheduleHeightUpdate);
+    connect(docLayout, &QAbstractTextDocumentLayout::updateBlock, this,
+        &MarkdownEdit::scheduleHeightUpdate);
+
     connect(m_edit, &QMarkdownTextEdit::textChanged, this, &MarkdownEdit::updateText);
     connect(qApp, &QApplication::focusChanged, this, &MarkdownEdit::catchFocus);
 
-    setColors(QHash<QString, QColor> {});
-    updateText();
+    updateHeight();
 }
 
 QString MarkdownEdit::text() const
@@ -269,7 +70,7 @@ void MarkdownEdit::setText(const QString& str)
     if (text() == str) {
         return;
     }
-    m_edit->setText(str);
+    m_highlighter->setText(str);
 }
 
 void MarkdownEdit::setPlaceholderText(const QString& str)
@@ -277,10 +78,16 @@ void MarkdownEdit::setPlaceholderText(const QString& str)
     m_edit->setPlaceholderText(str);
 }
 
-void MarkdownEdit::setColors(const QHash<QString, QColor>& colors)
+int MarkdownEdit::fontSize() const
+{
+    return m_fontSize;
+}
+
+void MarkdownEdit::setTextFormats(
+    const QHash<MarkdownHighlighter::HighlighterState, QTextCharFormat>& formats)
 {
-    m_edit->highlighter()->setTextFormats(createFormatMap(colors, m_fontSize));
-    m_edit->setText(text());
+    m_highlighter->setTextFormats(formats);
+    m_highlighter->rehighlightIncrementally();
 }
 
 void MarkdownEdit::startEditing()
@@ -312,9 +119,11 @@ bool MarkdownEdit::eventFilter(QObject* obj, QEvent* event)
 
 void MarkdownEdit::paintEvent(QPaintEvent* event)
 {
+    TRACE_SPAN("MarkdownEdit::paintEvent");
+
     if (m_firstPaint) {
         m_firstPaint = false;
-        updateText();
+        updateHeight();
     }
     QWidget::paintEvent(event);
 }
@@ -341,9 +150,26 @@ void MarkdownEdit::catchFocus(QWidget* old, QWidget* now)
 
 void MarkdownEdit::updateText()
 {
+    textChanged(text());
+}
+
+void MarkdownEdit::scheduleHeightUpdate()
+{
+    if (!m_heightTimer.isActive()) {
+        m_heightTimer.start();
+    }
+}
+
+void MarkdownEdit::updateHeight()
+{
+    TRACE_SPAN("MarkdownEdit::updateHeight");
+
+    m_heightTimer.stop();
+
     auto doc = m_edit->document();
     auto layout = doc->documentLayout();
 
+    // plain text layout reports its size in lines, so heights are summed
     qreal docHeight {};
     for (auto block = doc->begin(); block != doc->end(); block = block.next()) {
         docHeight += layout->blockBoundingRect(block).height();
@@ -351,10 +177,14 @@ void MarkdownEdit::updateText()
 
     auto widgetHeight = int(docHeight + doc->documentMargin());
 
+    // resizing relayouts whole record list, so skip it when possible
+    if (widgetHeight == m_docHeight) {
+        return;
+    }
+    m_docHeight = widgetHeight;
+
     m_edit->setFixedHeight(widgetHeight + 2);
     setFixedHeight(widgetHeight + m_vMargin * 2 + 1);
-
-    textChanged(text());
 }
 
 } // namespace tagberry::widgets
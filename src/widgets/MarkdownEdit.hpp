@@ -10,13 +10,19 @@
 #pragma once
 
 #include <QPlainTextEdit>
+#include <QTextCharFormat>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QWidget>
 
+#include <markdownhighlighter.h>
+
 class QMarkdownTextEdit;
 
 namespace tagberry::widgets {
 
+class IncrementalHighlighter;
+
 class MarkdownEdit : public QWidget {
     Q_OBJECT
 
@@ -27,7 +33,11 @@ public:
     void setText(const QString& str);
 
     void setPlaceholderText(const QString&);
-    void setColors(const QHash<QString, QColor>& colors);
+    int fontSize() const;
+
+    // formats of highlighter states, see ColorScheme::textFormats()
+    void setTextFormats(
+        const QHash<MarkdownHighlighter::HighlighterState, QTextCharFormat>& formats);
 
     void startEditing();
 
@@ -43,13 +53,19 @@ protected:
 
 private slots:
     void updateText();
+    void scheduleHeightUpdate();
+    void updateHeight();
     void catchFocus(QWidget* old, QWidget* now);
 
 private:
     QVBoxLayout m_layout;
     QMarkdownTextEdit* m_edit;
+    IncrementalHighlighter* m_highlighter;
     QString m_lastText;
 
+    QTimer m_heightTimer;
+    int m_docHeight { -1 };
+
     int m_hMargin { 6 };
     int m_vMargin { 4 };
     int m_fontSize { 11 };
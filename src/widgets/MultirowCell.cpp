@@ -8,6 +8,7 @@
  */
 
 #include "widgets/MultirowCell.hpp"
+#include "trace/Trace.hpp"
 
 #include <QApplication>
 #include <QDate>
@@ -110,6 +111,8 @@ void MultirowCell::setSeparatorColor(QColor color)
 
 void MultirowCell::paintEvent(QPaintEvent* event)
 {
+    TRACE_SPAN("MultirowCell::paintEvent");
+
     QPainter pt(this);
 
     pt.setRenderHint(QPainter::Qt4CompatiblePainting, true);
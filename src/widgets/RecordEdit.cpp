@@ -130,6 +130,11 @@ QString RecordEdit::description() const
     return m_descEdit.text();
 }
 
+int RecordEdit::descriptionFontSize() const
+{
+    return m_descEdit.fontSize();
+}
+
 void RecordEdit::notifyRemoving()
 {
     removing();
@@ -159,7 +164,12 @@ void RecordEdit::setColors(QHash<QString, QColor> colors)
     m_cell.setRowColor(Row_Desc, colors["background"]);
 
     m_completeCheckbox.setColors(colors["background-dimmed"], colors["border"]);
-    m_descEdit.setColors(colors);
+}
+
+void RecordEdit::setTextFormats(
+    QHash<MarkdownHighlighter::HighlighterState, QTextCharFormat> formats)
+{
+    m_descEdit.setTextFormats(formats);
 }
 
 void RecordEdit::updateVisibility()
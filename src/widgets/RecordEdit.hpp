@@ -32,6 +32,7 @@ public:
     QString title() const;
     QList<TagLabel*> tags() const;
     QString description() const;
+    int descriptionFontSize() const;
 
     void setTags(QList<TagLabel*>);
 
@@ -63,6 +64,7 @@ public slots:
     void setTitle(QString);
     void setDescription(QString);
     void setColors(QHash<QString, QColor>);
+    void setTextFormats(QHash<MarkdownHighlighter::HighlighterState, QTextCharFormat>);
 
 private slots:
     void cellClicked();
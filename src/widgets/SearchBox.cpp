@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "widgets/SearchBox.hpp"
+
+#include <QScrollBar>
+
+namespace tagberry::widgets {
+
+SearchBox::SearchBox(QWidget* parent)
+    : QWidget(parent)
+{
+    setLayout(&m_layout);
+
+    m_layout.setContentsMargins(QMargins(0, 0, 2, 0));
+    m_layout.setSpacing(4);
+    m_layout.addWidget(&m_edit);
+    m_layout.addWidget(&m_results, 1);
+
+    m_edit.setPlaceholderText("search");
+    m_edit.setClearButtonEnabled(true);
+
+    m_results.setFrameShape(QFrame::NoFrame);
+    m_results.setUniformItemSizes(true);
+    m_results.hide();
+
+    connect(&m_edit, &QLineEdit::textChanged, this, [=](QString text) {
+        m_results.setVisible(!text.trimmed().isEmpty());
+        queryChanged(text);
+    });
+
+    connect(&m_results, &QListWidget::itemActivated, this,
+        [=](QListWidgetItem* item) { resultActivated(m_results.row(item)); });
+
+    connect(&m_results, &QListWidget::itemClicked, this,
+        [=](QListWidgetItem* item) { resultActivated(m_results.row(item)); });
+
+    auto scrollBar = m_results.verticalScrollBar();
+
+    connect(scrollBar, &QScrollBar::valueChanged, this, &SearchBox::checkScrollEnd);
+    connect(scrollBar, &QScrollBar::rangeChanged, this, &SearchBox::checkScrollEnd);
+}
+
+QString SearchBox::query() const
+{
+    return m_edit.text();
+}
+
+void SearchBox::clearQuery()
+{
+    m_edit.clear();
+}
+
+int SearchBox::resultCount() const
+{
+    return m_results.count();
+}
+
+void SearchBox::clearResults()
+{
+    m_results.clear();
+}
+
+void SearchBox::addResult(
+    const QDate& date, const QString& title, const QString& snippet, bool complete)
+{
+    auto item = new QListWidgetItem;
+
+    item->setText(QString("%1  %2\n%3")
+                      .arg(date.toString(Qt::ISODate), title, snippet.simplified()));
+    item->setToolTip(snippet);
+    item->setForeground(complete ? m_dimmedTextColor : m_textColor);
+
+    m_results.addItem(item);
+}
+
+bool SearchBox::isScrolledToEnd() const
+{
+    auto scrollBar = m_results.verticalScrollBar();
+
+    return scrollBar->value() >= scrollBar->maximum() - scrollBar->pageStep();
+}
+
+void SearchBox::checkScrollEnd()
+{
+    if (m_results.count() && isScrolledToEnd()) {
+        moreResultsWanted();
+    }
+}
+
+void SearchBox::setColors(QHash<QString, QColor> colors)
+{
+    m_textColor = colors["text"];
+    m_dimmedTextColor = colors["text-dimmed"];
+
+    m_results.setStyleSheet(
+        QString("QListWidget { background-color: %1; }").arg(colors["background"].name()));
+}
+
+} // namespace tagberry::widgets
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QColor>
+#include <QDate>
+#include <QHash>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QVBoxLayout>
+#include <QWidget>
+
+namespace tagberry::widgets {
+
+class SearchBox : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit SearchBox(QWidget* parent = nullptr);
+
+    QString query() const;
+    void clearQuery();
+
+    int resultCount() const;
+
+    // last results are visible, or list isn't filled
+    bool isScrolledToEnd() const;
+
+    void clearResults();
+    void addResult(
+        const QDate& date, const QString& title, const QString& snippet, bool complete);
+
+signals:
+    void queryChanged(QString);
+    void resultActivated(int index);
+
+    // list became scrolled to end
+    void moreResultsWanted();
+
+public slots:
+    void setColors(QHash<QString, QColor>);
+
+private:
+    void checkScrollEnd();
+
+    QVBoxLayout m_layout;
+    QLineEdit m_edit;
+    QListWidget m_results;
+
+    QColor m_textColor { "#000000" };
+    QColor m_dimmedTextColor { "#999999" };
+};
+
+} // namespace tagberry::widgets
@@ -45,6 +45,11 @@ void TagCalendar::setToday()
     m_calendar->setToday();
 }
 
+void TagCalendar::setCurrentDate(const QDate& date)
+{
+    m_calendar->setDate(date);
+}
+
 QPair<QDate, QDate> TagCalendar::getVisibleRange() const
 {
     return m_calendar->getVisibleRange();
@@ -33,6 +33,7 @@ public:
     void clearTags();
 
     void setToday();
+    void setCurrentDate(const QDate&);
 
     int headerHeight();
 
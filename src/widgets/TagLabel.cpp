@@ -8,7 +8,9 @@
  */
 
 #include "widgets/TagLabel.hpp"
+#include "trace/Trace.hpp"
 
+#include <QAbstractItemView>
 #include <QFontMetrics>
 #include <QMouseEvent>
 #include <QPainter>
@@ -34,6 +36,7 @@ int horizontalAdvance(const QFontMetrics& m, const QString& s)
 TagLabel::TagLabel(QWidget* parent)
     : QWidget(parent)
     , m_edit(nullptr)
+    , m_completer(nullptr)
     , m_closeButton(false)
     , m_isEditable(false)
     , m_fgRegular(0x3e, 0x3e, 0x3e)
@@ -163,6 +166,38 @@ void TagLabel::setColors(QHash<QString, QColor> colors)
     update();
 }
 
+void TagLabel::setCompletions(QStringList completions)
+{
+    if (!m_edit) {
+        return;
+    }
+
+    // nothing to suggest besides what is already typed
+    if (completions.isEmpty()
+        || (completions.size() == 1 && completions[0] == m_edit->text())) {
+        if (m_completer) {
+            m_completer->popup()->hide();
+        }
+        return;
+    }
+
+    if (!m_completer) {
+        // completions are already filtered and ranked by caller
+        m_completer = new QCompleter(&m_completions, m_edit);
+        m_completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+        m_completer->setCaseSensitivity(Qt::CaseInsensitive);
+        m_edit->setCompleter(m_completer);
+    }
+
+    // caller limits list size, so popup never needs scrolling
+    m_completer->setMaxVisibleItems(completions.size());
+    m_completions.setStringList(completions);
+
+    if (m_edit->hasFocus()) {
+        m_completer->complete();
+    }
+}
+
 void TagLabel::setFont(const QFont& font)
 {
     if (m_font == font) {
@@ -261,6 +296,8 @@ void TagLabel::updateColors()
 
 void TagLabel::paintEvent(QPaintEvent*)
 {
+    TRACE_SPAN("TagLabel::paintEvent");
+
     if (m_edit) {
         QPainter pt(this);
         doPaint(pt);
@@ -458,11 +495,14 @@ void TagLabel::startEditing()
     m_oldText = m_text;
 
     connect(m_edit, &QLineEdit::textChanged, this, &TagLabel::setText);
+    connect(m_edit, &QLineEdit::textEdited, this, &TagLabel::completionRequested);
     connect(m_edit, &QLineEdit::editingFinished, this, &TagLabel::finishEditing);
 
     m_layout.addWidget(m_edit);
 
     m_edit->setFocus(Qt::MouseFocusReason);
+
+    completionRequested(m_text);
 }
 
 void TagLabel::finishEditing()
@@ -475,6 +515,7 @@ void TagLabel::finishEditing()
 
     m_edit->deleteLater();
     m_edit = nullptr;
+    m_completer = nullptr;
 
     editingFinished(m_oldText, m_text);
 
@@ -10,10 +10,13 @@
 #pragma once
 
 #include <QColor>
+#include <QCompleter>
 #include <QFont>
 #include <QHash>
 #include <QLineEdit>
 #include <QString>
+#include <QStringList>
+#include <QStringListModel>
 #include <QVBoxLayout>
 #include <QWidget>
 
@@ -50,6 +53,9 @@ public slots:
 
     void setColors(QHash<QString, QColor> colors);
 
+    // suggestions for text being edited, ignored if not editing
+    void setCompletions(QStringList completions);
+
 signals:
     void textChanged(QString);
 
@@ -59,6 +65,9 @@ signals:
     void editingStarted();
     void editingFinished(QString oldText, QString newText);
 
+    // emitted when editing starts and when user changes text
+    void completionRequested(QString prefix);
+
 private slots:
     void finishEditing();
 
@@ -78,6 +87,8 @@ private:
 
     QVBoxLayout m_layout;
     QLineEdit* m_edit;
+    QCompleter* m_completer;
+    QStringListModel m_completions;
 
     QString m_oldText;
     QString m_text;
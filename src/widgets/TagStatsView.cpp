@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "widgets/TagStatsView.hpp"
+
+#include <QHeaderView>
+
+namespace tagberry::widgets {
+
+TagStatsView::TagStatsView(QWidget* parent)
+    : QWidget(parent)
+{
+    m_table.setColumnCount(4);
+    m_table.setHeaderLabels({ "Tag", "Total", "Open", "Last used" });
+    m_table.setRootIsDecorated(false);
+    m_table.setUniformRowHeights(true);
+    m_table.setSortingEnabled(true);
+    m_table.sortByColumn(TotalColumn, Qt::DescendingOrder);
+    m_table.header()->setSectionResizeMode(NameColumn, QHeaderView::Stretch);
+    m_table.header()->setStretchLastSection(false);
+
+    m_layout.setContentsMargins(QMargins(0, 0, 0, 0));
+    m_layout.addWidget(&m_table);
+
+    setLayout(&m_layout);
+
+    connect(&m_table, &QTreeWidget::itemActivated, this,
+        [=](QTreeWidgetItem* item, int) {
+            tagActivated(item->data(NameColumn, Qt::UserRole).toUInt());
+        });
+}
+
+void TagStatsView::clearStats()
+{
+    m_table.clear();
+    m_items.clear();
+}
+
+void TagStatsView::beginUpdate()
+{
+    m_table.setSortingEnabled(false);
+}
+
+void TagStatsView::endUpdate()
+{
+    // keeps sort column and order chosen by user
+    m_table.setSortingEnabled(true);
+}
+
+void TagStatsView::setTagStats(
+    quint32 key, const QString& name, int total, int open, const QDate& lastUsed)
+{
+    auto item = m_items.value(key);
+    if (!item) {
+        item = new QTreeWidgetItem(&m_table);
+        item->setData(NameColumn, Qt::UserRole, key);
+        m_items.insert(key, item);
+    }
+
+    // numbers and dates are stored as is, so that sorting is not lexical
+    item->setData(NameColumn, Qt::DisplayRole, name);
+    item->setData(TotalColumn, Qt::DisplayRole, total);
+    item->setData(OpenColumn, Qt::DisplayRole, open);
+    item->setData(LastUsedColumn, Qt::DisplayRole, lastUsed);
+}
+
+} // namespace tagberry::widgets
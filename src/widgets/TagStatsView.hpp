@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QDate>
+#include <QHash>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include <QWidget>
+
+namespace tagberry::widgets {
+
+// Sortable table of tag usage counters, one row per tag.
+class TagStatsView : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit TagStatsView(QWidget* parent = nullptr);
+
+    void clearStats();
+
+    // rows set between these are sorted once, at the end
+    void beginUpdate();
+    void endUpdate();
+
+    // adds or updates row identified by key
+    void setTagStats(quint32 key, const QString& name, int total, int open,
+        const QDate& lastUsed);
+
+signals:
+    void tagActivated(quint32 key);
+
+private:
+    enum Column { NameColumn, TotalColumn, OpenColumn, LastUsedColumn };
+
+    QVBoxLayout m_layout;
+    QTreeWidget m_table;
+
+    QHash<quint32, QTreeWidgetItem*> m_items;
+};
+
+} // namespace tagberry::widgets
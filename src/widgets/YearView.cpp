@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "widgets/YearView.hpp"
+#include "trace/Trace.hpp"
+
+#include <QFontMetrics>
+#include <QHelpEvent>
+#include <QLocale>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QToolTip>
+
+#include <algorithm>
+
+namespace tagberry::widgets {
+
+YearView::YearView(QWidget* parent)
+    : QWidget(parent)
+    , m_year(QDate::currentDate().year())
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
+    setMouseTracking(true);
+
+    setYear(m_year);
+}
+
+int YearView::year() const
+{
+    return m_year;
+}
+
+void YearView::setYear(int year)
+{
+    m_year = year;
+    clearStats();
+}
+
+void YearView::clearStats()
+{
+    m_days.fill(Day(), QDate(m_year, 1, 1).daysInYear());
+    m_maxTotal = 0;
+
+    updateDayColors();
+    update();
+}
+
+void YearView::setDayStats(const QDate& date, int total, int complete)
+{
+    if (date.year() != m_year) {
+        return;
+    }
+
+    auto& day = m_days[date.dayOfYear() - 1];
+
+    if (day.total == total && day.complete == complete) {
+        return;
+    }
+
+    const int oldTotal = day.total;
+
+    day.total = total;
+    day.complete = complete;
+
+    if (m_updating) {
+        return;
+    }
+
+    if (total > m_maxTotal || (oldTotal == m_maxTotal && total < oldTotal)) {
+        // scale changed, all cells need new colors
+        m_maxTotal = 0;
+        for (const auto& d : m_days) {
+            m_maxTotal = std::max(m_maxTotal, d.total);
+        }
+        updateDayColors();
+        update();
+        return;
+    }
+
+    day.color = dayColor(day);
+
+    update(cellRect(date));
+}
+
+void YearView::beginUpdate()
+{
+    m_updating = true;
+}
+
+void YearView::endUpdate()
+{
+    m_updating = false;
+
+    m_maxTotal = 0;
+    for (const auto& day : m_days) {
+        m_maxTotal = std::max(m_maxTotal, day.total);
+    }
+
+    updateDayColors();
+    update();
+}
+
+QSize YearView::sizeHint() const
+{
+    return QSize(MaxWeeks * 14, NumDays * 14 + fontMetrics().height() + 4);
+}
+
+void YearView::setColors(QHash<QString, QColor> colors)
+{
+    m_textColor = colors["text"];
+    m_emptyColor = colors["background-dimmed"];
+    m_backgroundColor = colors["background"];
+
+    updateDayColors();
+    update();
+}
+
+bool YearView::event(QEvent* event)
+{
+    if (event->type() == QEvent::ToolTip) {
+        auto helpEvent = static_cast<QHelpEvent*>(event);
+        auto date = dateAt(helpEvent->pos());
+
+        if (date.isValid()) {
+            const auto& day = m_days[date.dayOfYear() - 1];
+            QToolTip::showText(helpEvent->globalPos(),
+                QString("%1: %2 records, %3 complete")
+                    .arg(QLocale().toString(date, QLocale::ShortFormat))
+                    .arg(day.total)
+                    .arg(day.complete),
+                this);
+        } else {
+            QToolTip::hideText();
+            event->ignore();
+        }
+
+        return true;
+    }
+
+    return QWidget::event(event);
+}
+
+void YearView::paintEvent(QPaintEvent* event)
+{
+    TRACE_SPAN("YearView::paintEvent");
+
+    QPainter pt(this);
+
+    pt.fillRect(event->rect(), m_backgroundColor);
+
+    pt.setPen(m_textColor);
+
+    QLocale locale;
+    for (int month = 1; month <= 12; month++) {
+        auto rect = cellRect(QDate(m_year, month, 1));
+        pt.drawText(QRect(rect.left(), 0, m_cellSize * 5, m_monthHeight),
+            Qt::AlignLeft | Qt::AlignVCenter, locale.monthName(month, QLocale::ShortFormat));
+    }
+
+    const QDate first(m_year, 1, 1);
+
+    for (int n = 0; n < m_days.size(); n++) {
+        auto rect = cellRect(first.addDays(n));
+        if (!rect.intersects(event->rect())) {
+            continue;
+        }
+        pt.fillRect(rect.adjusted(1, 1, -1, -1), m_days[n].color);
+    }
+}
+
+void YearView::resizeEvent(QResizeEvent* event)
+{
+    QWidget::resizeEvent(event);
+    updateCellLayout();
+}
+
+void YearView::mousePressEvent(QMouseEvent* event)
+{
+    if (event->button() != Qt::LeftButton) {
+        return;
+    }
+
+    auto date = dateAt(event->pos());
+    if (date.isValid()) {
+        dateClicked(date);
+    }
+}
+
+QDate YearView::dateAt(const QPoint& pos) const
+{
+    if (m_cellSize <= 0) {
+        return {};
+    }
+
+    auto p = pos - m_origin;
+    if (p.x() < 0 || p.y() < 0) {
+        return {};
+    }
+
+    const int week = p.x() / m_cellSize;
+    const int weekDay = p.y() / m_cellSize;
+
+    if (week >= MaxWeeks || weekDay >= NumDays) {
+        return {};
+    }
+
+    const QDate first(m_year, 1, 1);
+    const int offset = first.dayOfWeek() - 1;
+
+    auto date = first.addDays(week * NumDays + weekDay - offset);
+    if (date.year() != m_year) {
+        return {};
+    }
+
+    return date;
+}
+
+QRect YearView::cellRect(const QDate& date) const
+{
+    const QDate first(m_year, 1, 1);
+    const int offset = first.dayOfWeek() - 1;
+
+    const int index = date.dayOfYear() - 1 + offset;
+    const int week = index / NumDays;
+    const int weekDay = index % NumDays;
+
+    return QRect(m_origin.x() + week * m_cellSize, m_origin.y() + weekDay * m_cellSize,
+        m_cellSize, m_cellSize);
+}
+
+void YearView::updateCellLayout()
+{
+    m_monthHeight = fontMetrics().height() + 4;
+
+    m_cellSize
+        = std::max(4, std::min(width() / MaxWeeks, (height() - m_monthHeight) / NumDays));
+
+    m_origin = QPoint((width() - m_cellSize * MaxWeeks) / 2, m_monthHeight);
+
+    update();
+}
+
+void YearView::updateDayColors()
+{
+    for (auto& day : m_days) {
+        day.color = dayColor(day);
+    }
+}
+
+// lightness shows number of records, hue goes from orange to green
+// as more of them get complete
+QColor YearView::dayColor(const Day& day) const
+{
+    if (day.total <= 0 || m_maxTotal <= 0) {
+        return m_emptyColor;
+    }
+
+    const double intensity = std::max(0.25, double(day.total) / m_maxTotal);
+    const double ratio = double(day.complete) / day.total;
+
+    return QColor::fromHslF(
+        (30 + 90 * ratio) / 360.0, 0.55, 0.85 - 0.45 * intensity);
+}
+
+} // namespace tagberry::widgets
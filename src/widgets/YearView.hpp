@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2021 Tagberry authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QColor>
+#include <QDate>
+#include <QHash>
+#include <QVector>
+#include <QWidget>
+
+namespace tagberry::widgets {
+
+// Heatmap of a whole year, one cell per day, weeks in columns.
+// Cells are painted directly, without child widgets.
+class YearView : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit YearView(QWidget* parent = nullptr);
+
+    int year() const;
+    void setYear(int year);
+
+    void clearStats();
+    void setDayStats(const QDate& date, int total, int complete);
+
+    // days set between these are scaled and repainted once, at the end
+    void beginUpdate();
+    void endUpdate();
+
+    QSize sizeHint() const override;
+
+signals:
+    void dateClicked(QDate);
+
+public slots:
+    void setColors(QHash<QString, QColor>);
+
+protected:
+    bool event(QEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+
+private:
+    enum { NumDays = 7, MaxWeeks = 54 };
+
+    struct Day {
+        int total {};
+        int complete {};
+        QColor color;
+    };
+
+    QDate dateAt(const QPoint& pos) const;
+    QRect cellRect(const QDate& date) const;
+
+    void updateCellLayout();
+    void updateDayColors();
+    QColor dayColor(const Day& day) const;
+
+    int m_year;
+    QVector<Day> m_days;
+    int m_maxTotal {};
+    bool m_updating {};
+
+    QPoint m_origin;
+    int m_cellSize {};
+    int m_monthHeight {};
+
+    QColor m_textColor { "#000000" };
+    QColor m_emptyColor { "#f2f2f2" };
+    QColor m_backgroundColor { "#ffffff" };
+};
+
+} // namespace tagberry::widgets